@@ -3,9 +3,11 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 CONFIG += c++17
 DEFINES += QT_DEPRECATED_WARNINGS
 RESOURCES += gui/resources.qrc
+INCLUDEPATH += cpp_solvers/include
 
 
 SOURCES += \
+    cpp_solvers/src/cache.cpp \
     gui/display/display.cpp \
     gui/display/view.cpp \
     gui/leaderboard.cpp \
@@ -186,9 +188,12 @@ SOURCES += \
     solvers/2025/puzzle_2025_11.cpp \
     solvers/2025/puzzle_2025_12.cpp \
     solvers/common.cpp \
-    solvers/solvers.cpp
+    solvers/md5search.cpp \
+    solvers/solvers.cpp \
+    solvers/threadpool.cpp
 
 HEADERS += \
+    cpp_solvers/include/cache.hpp \
     gui/display/display.h \
     gui/display/view.h \
     gui/jsonhelper.h \
@@ -377,9 +382,11 @@ HEADERS += \
     solvers/2025/puzzle_2025_11.h \
     solvers/2025/puzzle_2025_12.h \
     solvers/common.h \
+    solvers/md5search.h \
     solvers/qchar_hash.hpp \
     solvers/qpoint_hash.hpp \
-    solvers/solvers.h
+    solvers/solvers.h \
+    solvers/threadpool.h
 
 FORMS += \
     gui/display/display.ui \
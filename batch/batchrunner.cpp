@@ -0,0 +1,168 @@
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QPair>
+#include <algorithm>
+#include <batch/batchrunner.h>
+#include <solvers/threadpool.h>
+
+namespace batch {
+
+QString inputFilepath(const QString &inputs_dirpath, int year, int day) {
+  return QDir(inputs_dirpath)
+      .filePath(QString("%1/%2.txt").arg(year).arg(day, 2, 10, QChar('0')));
+}
+
+std::optional<QString> readInput(const QString &inputs_dirpath, int year,
+                                 int day) {
+  QFile file(inputFilepath(inputs_dirpath, year, day));
+  if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return std::nullopt;
+  auto input = QString(file.readAll());
+  while (not input.isEmpty() and input.back() == '\n')
+    input.chop(1);
+  return input;
+}
+
+RunResult runSolver(Solver &solver, const QString &input) {
+  auto result = RunResult();
+  const auto connection = QObject::connect(
+      &solver, &Solver::finished, [&result](const QString &answer) {
+        result.success = true;
+        result.answer = answer;
+      });
+  QElapsedTimer timer;
+  timer.start();
+  try {
+    solver.solve(input);
+  } catch (const std::exception &e) {
+    result.success = false;
+    result.answer = QString("ERROR: %1").arg(e.what());
+  }
+  result.wall_time_ns = timer.nsecsElapsed();
+  QObject::disconnect(connection);
+  return result;
+}
+
+/******************************************************************************/
+
+BatchRunner::BatchRunner(const Solvers &solvers, const QString &inputs_dirpath)
+    : m_solvers{solvers}, m_inputs_dirpath{inputs_dirpath} {}
+
+std::vector<PuzzleId> BatchRunner::puzzles(int year, int day) const {
+  auto res = std::vector<PuzzleId>();
+  for (auto y : m_solvers.m_solvers.keys()) {
+    if (year != 0 and y != year)
+      continue;
+    for (auto d : m_solvers.m_solvers[y].keys()) {
+      if (day != 0 and d != day)
+        continue;
+      for (auto p : m_solvers.m_solvers[y][d].keys())
+        res.push_back(PuzzleId{y, d, p});
+    }
+  }
+  return res;
+}
+
+void BatchRunner::run(const std::vector<PuzzleId> &puzzles,
+                      std::size_t nb_jobs) {
+  QElapsedTimer timer;
+  timer.start();
+
+  auto inputs = QMap<QPair<int, int>, std::optional<QString>>();
+  m_reports.assign(puzzles.size(), PuzzleReport());
+  for (auto i = std::size_t{0}; i < puzzles.size(); ++i) {
+    const auto &id = puzzles[i];
+    const auto key = qMakePair(id.year, id.day);
+    if (not inputs.contains(key)) {
+      inputs[key] = readInput(m_inputs_dirpath, id.year, id.day);
+      if (not inputs[key] and m_cache) {
+        if (const auto cached = m_cache->input(id.year, id.day))
+          inputs[key] = QString::fromStdString(*cached);
+      }
+    }
+    m_reports[i].id = id;
+  }
+
+  // Both parts of a day may share static state, so they run in the same task
+  auto days = QMap<QPair<int, int>, std::vector<std::size_t>>();
+  for (auto i = std::size_t{0}; i < puzzles.size(); ++i)
+    days[qMakePair(puzzles[i].year, puzzles[i].day)].push_back(i);
+
+  common::ThreadPool pool(nb_jobs);
+  m_nb_jobs = pool.size();
+  for (auto it = days.cbegin(); it != days.cend(); ++it) {
+    const auto &input = inputs[it.key()];
+    auto runnable = std::vector<std::pair<PuzzleReport *, Solver *>>();
+    for (const auto i : it.value()) {
+      auto &report = m_reports[i];
+      auto *solver = m_solvers(report.id.year, report.id.day, report.id.part);
+      if (not solver)
+        report.status = "not_implemented";
+      else if (solver->requiresGuiThread())
+        report.status = "gui_only";
+      else if (not input)
+        report.status = "no_input";
+      else
+        runnable.emplace_back(&report, solver);
+    }
+    if (runnable.empty())
+      continue;
+    pool.submit([this, runnable, &input]() {
+      const auto input_str = input->toStdString();
+      for (const auto &[report, solver] : runnable) {
+        const auto &id = report->id;
+        if (m_cache) {
+          if (const auto answer =
+                  m_cache->answer(id.year, id.day, id.part, input_str)) {
+            report->result.success = true;
+            report->result.answer = QString::fromStdString(*answer);
+            report->status = "cached";
+            continue;
+          }
+        }
+        report->result = runSolver(*solver, *input);
+        report->status = report->result.success ? "solved" : "error";
+        if (m_cache and report->result.success) {
+          m_cache->storeAnswer(id.year, id.day, id.part, input_str,
+                               report->result.answer.toStdString());
+        }
+      }
+    });
+  }
+  pool.wait();
+
+  m_wall_time_ns = timer.nsecsElapsed();
+}
+
+int BatchRunner::nbFailures() const {
+  return static_cast<int>(
+      std::count_if(std::cbegin(m_reports), std::cend(m_reports),
+                    [](const PuzzleReport &report) {
+                      return report.status == "error";
+                    }));
+}
+
+QJsonObject BatchRunner::toJson() const {
+  auto puzzles = QJsonArray();
+  for (const auto &report : m_reports) {
+    auto puzzle = QJsonObject();
+    puzzle["year"] = report.id.year;
+    puzzle["day"] = report.id.day;
+    puzzle["part"] = report.id.part;
+    puzzle["status"] = report.status;
+    puzzle["answer"] = report.result.answer;
+    puzzle["wall_time_ms"] = report.result.wall_time_ns / 1e6;
+    puzzles.append(puzzle);
+  }
+  auto root = QJsonObject();
+  root["inputs"] = QDir(m_inputs_dirpath).absolutePath();
+  root["jobs"] = static_cast<qint64>(m_nb_jobs);
+  root["wall_time_ms"] = m_wall_time_ns / 1e6;
+  root["failures"] = nbFailures();
+  root["puzzles"] = puzzles;
+  return root;
+}
+
+} // namespace batch
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <cache.hpp>
+#include <optional>
+#include <solvers/solvers.h>
+#include <vector>
+
+namespace batch {
+
+struct PuzzleId {
+  int year{0};
+  int day{0};
+  int part{0};
+};
+
+struct RunResult {
+  bool success{false};
+  QString answer{};
+  qint64 wall_time_ns{0};
+};
+
+QString inputFilepath(const QString &inputs_dirpath, int year, int day);
+std::optional<QString> readInput(const QString &inputs_dirpath, int year,
+                                 int day);
+
+// Runs the solver on the calling thread and captures its last answer
+RunResult runSolver(Solver &solver, const QString &input);
+
+struct PuzzleReport {
+  PuzzleId id{};
+  QString status{"pending"};
+  RunResult result{};
+};
+
+class BatchRunner {
+public:
+  BatchRunner(const Solvers &solvers, const QString &inputs_dirpath);
+
+  // A null year or day selects every registered one
+  std::vector<PuzzleId> puzzles(int year = 0, int day = 0) const;
+
+  // Inputs missing from the inputs directory are then read from the cache,
+  // cached answers are reused and new ones are stored
+  void setCache(const aoc::Cache *cache) { m_cache = cache; }
+
+  void run(const std::vector<PuzzleId> &puzzles, std::size_t nb_jobs);
+
+  const std::vector<PuzzleReport> &reports() const { return m_reports; }
+  int nbFailures() const;
+  QJsonObject toJson() const;
+
+private:
+  const Solvers &m_solvers;
+  QString m_inputs_dirpath;
+  const aoc::Cache *m_cache{nullptr};
+  std::vector<PuzzleReport> m_reports{};
+  std::size_t m_nb_jobs{0};
+  qint64 m_wall_time_ns{0};
+};
+
+} // namespace batch
@@ -0,0 +1,181 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QPair>
+#include <QTextStream>
+#include <algorithm>
+#include <aoc.hpp>
+#include <batch/batchrunner.h>
+#include <batch/benchmark.h>
+#include <functional>
+#include <optional>
+
+namespace {
+
+struct Benchmark {
+  QString key;
+  std::function<bool(QString &)> run;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("aoc_bench");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Times every registered solver on inputs read from <inputs>/<year>/"
+      "<day>.txt and flags regressions against the timing history.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("inputs", "Root directory of the inputs.");
+  QCommandLineOption runs_option({"n", "runs"}, "Number of runs per solver.",
+                                 "runs", "5");
+  QCommandLineOption history_option({"H", "history"},
+                                    "Timing history file.", "file",
+                                    "bench_history.json");
+  QCommandLineOption threshold_option(
+      {"t", "threshold"},
+      "Relative median slowdown flagged as a regression (0.1 for 10%).",
+      "threshold", "0.1");
+  QCommandLineOption year_option({"y", "year"}, "Only benchmark this year.",
+                                 "year", "0");
+  QCommandLineOption day_option({"d", "day"}, "Only benchmark this day.",
+                                "day", "0");
+  QCommandLineOption reference_option(
+      {"r", "reference"},
+      "Compare against the history run recorded at this timestamp instead of "
+      "the fastest recorded run of each solver.",
+      "timestamp");
+  QCommandLineOption dry_option("dry-run",
+                                "Do not append the results to the history.");
+  parser.addOption(runs_option);
+  parser.addOption(history_option);
+  parser.addOption(threshold_option);
+  parser.addOption(year_option);
+  parser.addOption(day_option);
+  parser.addOption(reference_option);
+  parser.addOption(dry_option);
+  parser.process(app);
+
+  const auto arguments = parser.positionalArguments();
+  if (arguments.size() != 1)
+    parser.showHelp(1);
+  const auto inputs_dirpath = arguments.front();
+  const auto nb_runs = std::max(1, parser.value(runs_option).toInt());
+  const auto threshold = parser.value(threshold_option).toDouble();
+  const auto year = parser.value(year_option).toInt();
+  const auto day = parser.value(day_option).toInt();
+  const auto reference = parser.value(reference_option);
+
+  QTextStream out(stdout);
+  batch::BenchmarkHistory history(parser.value(history_option));
+  const auto error = history.load();
+  if (not error.isEmpty()) {
+    out << QString("cannot load history: %1\n").arg(error);
+    return 1;
+  }
+  if (not reference.isEmpty() and not history.hasRun(reference)) {
+    out << QString("no run recorded at \"%1\" in the history\n")
+               .arg(reference);
+    return 1;
+  }
+
+  Solvers solvers;
+  auto inputs = QMap<QPair<int, int>, std::optional<QString>>();
+  const auto cachedInput = [&](int y, int d) -> const std::optional<QString> & {
+    const auto key = qMakePair(y, d);
+    if (not inputs.contains(key))
+      inputs[key] = batch::readInput(inputs_dirpath, y, d);
+    return inputs[key];
+  };
+
+  auto benchmarks = std::vector<Benchmark>();
+  const auto runner = batch::BatchRunner(solvers, inputs_dirpath);
+  for (const auto &id : runner.puzzles(year, day)) {
+    auto *solver = solvers(id.year, id.day, id.part);
+    const auto &input = cachedInput(id.year, id.day);
+    if (not solver or solver->requiresGuiThread() or not input)
+      continue;
+    benchmarks.push_back(
+        {QString("%1/%2/%3")
+             .arg(id.year)
+             .arg(id.day, 2, 10, QChar('0'))
+             .arg(id.part),
+         [solver, &input](QString &error) {
+           const auto result = batch::runSolver(*solver, *input);
+           if (not result.success)
+             error = result.answer;
+           return result.success;
+         }});
+  }
+  for (auto y = 2015; y <= 2025; ++y) {
+    for (auto d = 1; d <= 25; ++d) {
+      if ((year != 0 and y != year) or (day != 0 and d != day) or
+          not aoc::hasSolver(y, d))
+        continue;
+      const auto &input = cachedInput(y, d);
+      if (not input)
+        continue;
+      benchmarks.push_back(
+          {QString("%1/%2/cpp").arg(y).arg(d, 2, 10, QChar('0')),
+           [y, d, text = input->toStdString()](QString &error) {
+             const auto result = aoc::solve(y, d, text);
+             if (not result.success and not result.output.empty())
+               error = QString::fromStdString(result.output.front());
+             return result.success;
+           }});
+    }
+  }
+
+  auto nb_regressions = 0;
+  for (const auto &benchmark : benchmarks) {
+    auto wall_times_ns = std::vector<qint64>();
+    auto error = QString();
+    batch::resetPeakRss();
+    for (auto i = 0; i < nb_runs and error.isEmpty(); ++i) {
+      QElapsedTimer timer;
+      timer.start();
+      if (benchmark.run(error))
+        wall_times_ns.push_back(timer.nsecsElapsed());
+      else if (error.isEmpty())
+        error = "failure";
+    }
+    if (not error.isEmpty()) {
+      out << QString("%1 ERROR %2\n")
+                 .arg(benchmark.key)
+                 .arg(error.section('\n', 0, 0));
+      continue;
+    }
+    const auto timings = batch::summarize(wall_times_ns, batch::peakRssKb());
+    const auto baseline = history.baseline(benchmark.key, reference);
+    auto verdict = QString();
+    if (baseline and baseline->median_ms > 0.0) {
+      const auto ratio = timings.median_ms / baseline->median_ms;
+      verdict = QString("%1%2%").arg(ratio >= 1.0 ? "+" : "").arg(
+          100.0 * (ratio - 1.0), 0, 'f', 1);
+      if (ratio > 1.0 + threshold) {
+        verdict += " REGRESSION";
+        ++nb_regressions;
+      }
+    }
+    out << QString("%1 min %2 ms median %3 ms p95 %4 ms rss %5 kB %6\n")
+               .arg(benchmark.key)
+               .arg(timings.min_ms, 0, 'f', 3)
+               .arg(timings.median_ms, 0, 'f', 3)
+               .arg(timings.p95_ms, 0, 'f', 3)
+               .arg(timings.peak_rss_kb)
+               .arg(verdict);
+    out.flush();
+    history.record(benchmark.key, timings);
+  }
+
+  if (not parser.isSet(dry_option) and not history.save()) {
+    out << QString("cannot save history to \"%1\"\n")
+               .arg(parser.value(history_option));
+    return 1;
+  }
+
+  return nb_regressions == 0 ? 0 : 2;
+}
@@ -0,0 +1,140 @@
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <algorithm>
+#include <batch/benchmark.h>
+#include <cmath>
+#include <sys/resource.h>
+
+namespace batch {
+
+namespace {
+
+double percentile(const std::vector<qint64> &sorted, double p) {
+  const auto rank = static_cast<std::size_t>(
+      std::ceil(p * static_cast<double>(sorted.size())));
+  return sorted[std::max(rank, std::size_t{1}) - 1] / 1e6;
+}
+
+} // namespace
+
+Timings summarize(std::vector<qint64> wall_times_ns, qint64 peak_rss_kb) {
+  auto res = Timings();
+  res.peak_rss_kb = peak_rss_kb;
+  if (wall_times_ns.empty())
+    return res;
+  std::sort(std::begin(wall_times_ns), std::end(wall_times_ns));
+  res.nb_runs = static_cast<int>(wall_times_ns.size());
+  res.min_ms = wall_times_ns.front() / 1e6;
+  res.median_ms = percentile(wall_times_ns, 0.5);
+  res.p95_ms = percentile(wall_times_ns, 0.95);
+  return res;
+}
+
+void resetPeakRss() {
+#ifdef Q_OS_LINUX
+  QFile file("/proc/self/clear_refs");
+  if (file.open(QIODevice::WriteOnly))
+    file.write("5");
+#endif
+}
+
+qint64 peakRssKb() {
+#ifdef Q_OS_LINUX
+  QFile file("/proc/self/status");
+  if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    for (const auto &line : QString(file.readAll()).split('\n')) {
+      if (line.startsWith("VmHWM:"))
+        return line.mid(6).trimmed().section(' ', 0, 0).toLongLong();
+    }
+  }
+#endif
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return static_cast<qint64>(usage.ru_maxrss);
+}
+
+/******************************************************************************/
+
+BenchmarkHistory::BenchmarkHistory(const QString &filepath)
+    : m_filepath{filepath} {
+  m_current["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+  m_current["results"] = QJsonObject();
+}
+
+QString BenchmarkHistory::load() {
+  QFile file(m_filepath);
+  if (not file.exists())
+    return "";
+  if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return QString("cannot open file \"%1\"").arg(m_filepath);
+  QJsonParseError error;
+  const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+  if (error.error != QJsonParseError::NoError)
+    return error.errorString();
+  if (not document.isObject() or not document.object()["runs"].isArray())
+    return QString("missing \"runs\" array in file \"%1\"").arg(m_filepath);
+  m_runs = document.object()["runs"].toArray();
+  return "";
+}
+
+bool BenchmarkHistory::save() const {
+  QFile file(m_filepath);
+  if (not file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return false;
+  auto runs = m_runs;
+  runs.append(m_current);
+  auto root = QJsonObject();
+  root["runs"] = runs;
+  file.write(QJsonDocument(root).toJson());
+  return true;
+}
+
+bool BenchmarkHistory::hasRun(const QString &timestamp) const {
+  return std::any_of(std::begin(m_runs), std::end(m_runs),
+                     [&timestamp](const QJsonValue &run) {
+                       return run.toObject()["timestamp"].toString() ==
+                              timestamp;
+                     });
+}
+
+std::optional<Timings>
+BenchmarkHistory::baseline(const QString &key,
+                           const QString &reference) const {
+  auto res = std::optional<Timings>();
+  for (const auto &run : m_runs) {
+    const auto run_object = run.toObject();
+    if (not reference.isEmpty() and
+        run_object["timestamp"].toString() != reference)
+      continue;
+    const auto results = run_object["results"].toObject();
+    if (not results.contains(key))
+      continue;
+    const auto object = results[key].toObject();
+    const auto median_ms = object["median_ms"].toDouble();
+    if (res and res->median_ms <= median_ms)
+      continue;
+    res = Timings();
+    res->nb_runs = object["runs"].toInt();
+    res->min_ms = object["min_ms"].toDouble();
+    res->median_ms = median_ms;
+    res->p95_ms = object["p95_ms"].toDouble();
+    res->peak_rss_kb = static_cast<qint64>(object["peak_rss_kb"].toDouble());
+  }
+  return res;
+}
+
+void BenchmarkHistory::record(const QString &key, const Timings &timings) {
+  auto object = QJsonObject();
+  object["runs"] = timings.nb_runs;
+  object["min_ms"] = timings.min_ms;
+  object["median_ms"] = timings.median_ms;
+  object["p95_ms"] = timings.p95_ms;
+  object["peak_rss_kb"] = timings.peak_rss_kb;
+  auto results = m_current["results"].toObject();
+  results[key] = object;
+  m_current["results"] = results;
+}
+
+} // namespace batch
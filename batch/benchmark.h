@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <optional>
+#include <vector>
+
+namespace batch {
+
+struct Timings {
+  int nb_runs{0};
+  double min_ms{0.0};
+  double median_ms{0.0};
+  double p95_ms{0.0};
+  qint64 peak_rss_kb{0};
+};
+
+Timings summarize(std::vector<qint64> wall_times_ns, qint64 peak_rss_kb);
+
+// Peak resident set size of the process. Resetting it is only supported on
+// Linux, elsewhere the peak is the one of the whole process.
+void resetPeakRss();
+qint64 peakRssKb();
+
+class BenchmarkHistory {
+public:
+  BenchmarkHistory(const QString &filepath);
+
+  QString load();
+  bool save() const;
+
+  bool hasRun(const QString &timestamp) const;
+
+  // Timings of this benchmark in the run recorded at the reference timestamp
+  // or, without reference, in the run where its median was the lowest, so
+  // that successive small slowdowns are not absorbed by the baseline
+  std::optional<Timings> baseline(const QString &key,
+                                  const QString &reference = "") const;
+
+  void record(const QString &key, const Timings &timings);
+
+private:
+  QString m_filepath;
+  QJsonArray m_runs{};
+  QJsonObject m_current{};
+};
+
+} // namespace batch
@@ -0,0 +1,93 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <batch/batchrunner.h>
+#include <solvers/threadpool.h>
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("aoc_batch");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Solves every registered puzzle on inputs read from <inputs>/<year>/"
+      "<day>.txt and writes a JSON report.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("inputs", "Root directory of the inputs.");
+  QCommandLineOption report_option(
+      {"r", "report"}, "Write the JSON report to <file> (\"-\" for stdout).",
+      "file", "-");
+  QCommandLineOption jobs_option({"j", "jobs"},
+                                 "Number of worker threads (0 for all cores).",
+                                 "jobs", "0");
+  QCommandLineOption year_option({"y", "year"}, "Only solve this year.",
+                                 "year", "0");
+  QCommandLineOption day_option({"d", "day"}, "Only solve this day.", "day",
+                                "0");
+  QCommandLineOption cache_option(
+      {"c", "cache"},
+      "Reuse and store answers in the shared on-disk cache, which also "
+      "provides the inputs missing from <inputs>.");
+  QCommandLineOption prune_cache_option(
+      "prune-cache", "Remove the cached answers computed by other versions of "
+                     "their solvers before solving.");
+  parser.addOption(report_option);
+  parser.addOption(jobs_option);
+  parser.addOption(year_option);
+  parser.addOption(day_option);
+  parser.addOption(cache_option);
+  parser.addOption(prune_cache_option);
+  parser.process(app);
+
+  const auto arguments = parser.positionalArguments();
+  if (arguments.size() != 1)
+    parser.showHelp(1);
+
+  auto nb_jobs = parser.value(jobs_option).toULongLong();
+  if (nb_jobs == 0)
+    nb_jobs = common::nbHardwareThreads();
+
+  QTextStream err(stderr);
+  const auto cache = aoc::Cache();
+  if (parser.isSet(prune_cache_option)) {
+    err << QString("Removed %1 stale cached answers\n")
+               .arg(cache.removeStaleAnswers());
+    err.flush();
+  }
+
+  Solvers solvers;
+  batch::BatchRunner runner(solvers, arguments.front());
+  if (parser.isSet(cache_option))
+    runner.setCache(&cache);
+  runner.run(runner.puzzles(parser.value(year_option).toInt(),
+                            parser.value(day_option).toInt()),
+             nb_jobs);
+
+  for (const auto &report : runner.reports()) {
+    err << QString("%1/%2/%3 %4 %5 ms %6\n")
+               .arg(report.id.year)
+               .arg(report.id.day, 2, 10, QChar('0'))
+               .arg(report.id.part)
+               .arg(report.status, -15)
+               .arg(report.result.wall_time_ns / 1e6, 10, 'f', 3)
+               .arg(report.result.answer.section('\n', 0, 0));
+  }
+  err.flush();
+
+  const auto json = QJsonDocument(runner.toJson()).toJson();
+  const auto report_filepath = parser.value(report_option);
+  if (report_filepath == "-") {
+    QTextStream(stdout) << json;
+  } else {
+    QFile file(report_filepath);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+      err << QString("cannot write report to \"%1\"\n").arg(report_filepath);
+      return 1;
+    }
+    file.write(json);
+  }
+
+  return runner.nbFailures() == 0 ? 0 : 2;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cache.hpp>
 #include <solvers.hpp>
 
 namespace aoc {
@@ -8,4 +9,9 @@ bool hasSolver(int year, int day);
 
 Result solve(int year, int day, const std::string &input);
 
+// Same as solve, but answers computed by the same version of the solver for
+// the same input are read from the cache, and new ones are stored into it
+Result solveCached(int year, int day, const std::string &input,
+                   const Cache &cache = Cache());
+
 } // namespace aoc
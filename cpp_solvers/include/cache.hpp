@@ -0,0 +1,51 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace aoc {
+
+// 64-bit FNV-1a digest of the data, as 16 hexadecimal digits
+std::string contentHash(const std::string &data);
+
+// Digest of the sources of the solvers of a day and of the shared code,
+// computed at configure time. Builds without digests (qmake) have no version,
+// and do not cache answers.
+std::optional<std::string> solverVersion(int year, int day);
+
+// On-disk store shared by the GUI, the Python module and the batch runner.
+// Inputs are stored without their trailing newlines, by content hash, and
+// answers are keyed by year, day, part, input hash and solver version:
+//   <root>/inputs/<input hash>.txt
+//   <root>/inputs/<year>/<day>          hash of the latest input of the day
+//   <root>/answers/<year>/<day>/<part>/<input hash>-<solver version>.txt
+class Cache {
+public:
+  Cache(const std::filesystem::path &root = defaultRoot());
+
+  // $AOC_CACHE_DIR, or ~/.config/AdventOfCode/cache
+  static std::filesystem::path defaultRoot();
+
+  const std::filesystem::path &root() const { return m_root; }
+
+  std::string storeInput(int year, int day, const std::string &input) const;
+  std::optional<std::string> input(int year, int day) const;
+
+  void storeAnswer(int year, int day, int part, const std::string &input,
+                   const std::string &answer) const;
+  std::optional<std::string> answer(int year, int day, int part,
+                                    const std::string &input) const;
+
+  // Removes the answers computed by other versions of their solvers, returns
+  // how many
+  std::size_t removeStaleAnswers() const;
+
+private:
+  std::optional<std::filesystem::path>
+  answerPath(int year, int day, int part, const std::string &input) const;
+
+  std::filesystem::path m_root;
+};
+
+} // namespace aoc
@@ -2,6 +2,7 @@
 
 #include <converters.hpp>
 #include <deque>
+#include <tokenizer.hpp>
 
 namespace aoc {
 
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace aoc {
+
+class Tokens {
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    Iterator() = default;
+
+    Iterator(std::string_view str, char delimiter, bool remove_empty)
+        : m_remaining{str}, m_delimiter{delimiter},
+          m_remove_empty{remove_empty}, m_end{false} {
+      advance();
+    }
+
+    reference operator*() const { return m_token; }
+    pointer operator->() const { return &m_token; }
+
+    Iterator &operator++() {
+      advance();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      auto copy = *this;
+      advance();
+      return copy;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return m_end == other.m_end and
+             (m_end or m_token.data() == other.m_token.data());
+    }
+
+    bool operator!=(const Iterator &other) const { return not(*this == other); }
+
+  private:
+    void advance() {
+      while (not m_remaining.empty()) {
+        const auto pos = m_remaining.find(m_delimiter);
+        m_token = m_remaining.substr(0, pos);
+        m_remaining.remove_prefix(pos == std::string_view::npos
+                                      ? m_remaining.size()
+                                      : pos + 1);
+        if (not m_remove_empty or not m_token.empty())
+          return;
+      }
+      m_end = true;
+    }
+
+    std::string_view m_remaining{};
+    std::string_view m_token{};
+    char m_delimiter{','};
+    bool m_remove_empty{true};
+    bool m_end{true};
+  };
+
+  Tokens(std::string_view str, char delimiter = ',', bool remove_empty = true)
+      : m_str{str}, m_delimiter{delimiter}, m_remove_empty{remove_empty} {}
+
+  Iterator begin() const {
+    return Iterator(m_str, m_delimiter, m_remove_empty);
+  }
+  Iterator end() const { return Iterator(); }
+
+private:
+  std::string_view m_str;
+  char m_delimiter;
+  bool m_remove_empty;
+};
+
+// Lazy, non-allocating split: the yielded views point into str, which must
+// outlive the iteration
+inline Tokens tokens(std::string_view str, char delimiter = ',',
+                     bool remove_empty = true) {
+  return Tokens(str, delimiter, remove_empty);
+}
+
+inline Tokens lines(std::string_view str, bool remove_empty = true) {
+  return Tokens(str, '\n', remove_empty);
+}
+
+// Same sign rules as the std::sto* based converters: leading whitespace and
+// a single '+' or '-' sign are accepted, trailing characters are not. A '-'
+// is rejected for unsigned types narrower than unsigned long (as toUInt does)
+// and wraps around for the wider ones (as toULongLongInt does)
+template <typename T> T parse(std::string_view str, int base = 10) {
+  static_assert(std::is_arithmetic_v<T>, "aoc::parse expects a number type");
+  const auto error = [str]() {
+    return std::runtime_error("cannot convert string \"" + std::string(str) +
+                              "\" to number");
+  };
+  auto first = str.data();
+  const auto last = str.data() + str.size();
+  while (first != last and (*first == ' ' or *first == '\t' or
+                            *first == '\r' or *first == '\n'))
+    ++first;
+  // from_chars takes neither '+' nor, for unsigned types, '-'
+  auto negate = false;
+  if (first != last and *first == '+') {
+    ++first;
+    if (first != last and *first == '-')
+      throw error();
+  } else if constexpr (std::is_unsigned_v<T>) {
+    if (first != last and *first == '-') {
+      if (sizeof(T) < sizeof(unsigned long))
+        throw error();
+      negate = true;
+      ++first;
+    }
+  }
+  auto value = T{};
+  auto result = std::from_chars_result{};
+  if constexpr (std::is_floating_point_v<T>)
+    result = std::from_chars(first, last, value);
+  else
+    result = std::from_chars(first, last, value, base);
+  if (result.ec != std::errc() or result.ptr != last or first == last)
+    throw error();
+  if constexpr (std::is_unsigned_v<T>) {
+    if (negate)
+      value = static_cast<T>(T{0} - value);
+  }
+  return value;
+}
+
+template <typename T>
+void splitTo(std::string_view str, std::vector<T> &values,
+             char delimiter = ',') {
+  values.clear();
+  for (const auto token : tokens(str, delimiter))
+    values.push_back(parse<T>(token));
+}
+
+template <typename T>
+std::vector<T> splitTo(std::string_view str, char delimiter = ',') {
+  auto values = std::vector<T>();
+  splitTo(str, values, delimiter);
+  return values;
+}
+
+// Parses at most capacity values into the caller-provided buffer and returns
+// the number of tokens found, which may exceed capacity
+template <typename T>
+std::size_t splitInto(std::string_view str, T *values, std::size_t capacity,
+                      char delimiter = ',') {
+  auto nb_tokens = std::size_t{0};
+  for (const auto token : tokens(str, delimiter)) {
+    if (nb_tokens < capacity)
+      values[nb_tokens] = parse<T>(token);
+    ++nb_tokens;
+  }
+  return nb_tokens;
+}
+
+} // namespace aoc
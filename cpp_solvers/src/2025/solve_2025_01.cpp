@@ -6,15 +6,14 @@ class Document {
 public:
   Document(const std::string &input) {
     auto dial_position = 50;
-    const auto lines = aoc::splitLines(input);
-    for (const auto &line : lines) {
+    for (const auto line : aoc::lines(input)) {
       const auto sign =
           line.front() == 'R' ? 1 : (line.front() == 'L' ? -1 : 0);
       if (sign == 0) {
-        throw std::invalid_argument("invalid line \"" + line +
+        throw std::invalid_argument("invalid line \"" + std::string(line) +
                                     "\" (bad direction)");
       }
-      const auto increment = aoc::toInt(line.substr(1));
+      const auto increment = aoc::parse<int>(line.substr(1));
       for (auto i = 0; i < increment; ++i) {
         dial_position = (dial_position + sign) % 100;
         if (dial_position == 0) {
@@ -82,22 +82,16 @@ private:
 
 class IDRange {
 public:
-  IDRange(const std::string &input) {
-    const auto values = aoc::splitToULongLongInt(input, '-');
-    if (std::size(values) != 2u) {
-      auto values_str = std::string("(");
-      for (auto it = std::cbegin(values); it != std::cend(values); ++it) {
-        values_str += std::to_string(*it);
-        if (std::next(it) != std::cend(values)) {
-          values_str += ", ";
-        }
-      }
-      values_str += ")";
-      throw std::invalid_argument("cannot parse range \"" + input +
-                                  "\": parsed values are " + values_str);
+  IDRange(std::string_view input) {
+    Int values[2];
+    const auto nb_values = aoc::splitInto(input, values, 2u, '-');
+    if (nb_values != 2u) {
+      throw std::invalid_argument("cannot parse range \"" + std::string(input) +
+                                  "\": expected 2 values, got " +
+                                  std::to_string(nb_values));
     }
-    m_begin = values.front();
-    m_end = values.back();
+    m_begin = values[0];
+    m_end = values[1];
   }
 
   Int getInvalidIDsSum(bool twice_only) const {
@@ -121,14 +115,13 @@ public:
 class GiftShopDatabase {
 public:
   GiftShopDatabase(const std::string &input) {
-    const auto lines = aoc::splitLines(input);
-    if (std::size(lines) != 1u) {
+    const auto lines = aoc::lines(input);
+    const auto nb_lines = std::distance(std::begin(lines), std::end(lines));
+    if (nb_lines != 1) {
       throw std::invalid_argument("invalid number of lines (expected 1, got " +
-                                  std::to_string(std::size(lines)) + ")");
+                                  std::to_string(nb_lines) + ")");
     }
-    const auto ranges_inputs = aoc::split(lines.front());
-    m_ID_ranges.reserve(std::size(ranges_inputs));
-    for (const auto &range_input : ranges_inputs) {
+    for (const auto range_input : aoc::tokens(*std::begin(lines))) {
       m_ID_ranges.emplace_back(range_input);
     }
   }
@@ -15,14 +15,14 @@ using Circuits =
     std::unordered_map<std::size_t, std::unordered_set<std::size_t>>;
 
 struct JunctionBox {
-  JunctionBox(const std::string &input) {
-    const auto values = aoc::splitToLongLongInt(input);
-    if (values.size() != 3) {
+  JunctionBox(std::string_view input) {
+    long long int values[3];
+    if (aoc::splitInto(input, values, 3u) != 3u) {
       throw std::invalid_argument("wrong size");
     }
-    x = values.at(0);
-    y = values.at(1);
-    z = values.at(2);
+    x = values[0];
+    y = values[1];
+    z = values[2];
   }
 
   Int x;
@@ -35,9 +35,7 @@ struct JunctionBox {
 class Boxes {
 public:
   Boxes(const std::string &input) {
-    const auto lines = aoc::splitLines(input);
-    m_boxes.reserve(lines.size());
-    for (const auto &line : lines) {
+    for (const auto line : aoc::lines(input)) {
       m_boxes.emplace_back(line);
     }
     for (auto i = 0u; i < m_boxes.size(); ++i) {
@@ -26,4 +26,23 @@ Result solve(int year, int day, const std::string &input) {
   return day_it->second(input);
 }
 
+Result solveCached(int year, int day, const std::string &input,
+                   const Cache &cache) {
+  const auto part_one = cache.answer(year, day, 1, input);
+  const auto part_two = cache.answer(year, day, 2, input);
+  if (part_one and part_two) {
+    auto result = Result();
+    result.part_one_solution = *part_one;
+    result.part_two_solution = *part_two;
+    result.output.emplace_back("answers read from cache");
+    return result;
+  }
+  auto result = solve(year, day, input);
+  if (result.success) {
+    cache.storeAnswer(year, day, 1, input, result.part_one_solution);
+    cache.storeAnswer(year, day, 2, input, result.part_two_solution);
+  }
+  return result;
+}
+
 } // namespace aoc
@@ -0,0 +1,210 @@
+#include <atomic>
+#include <cache.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+// Generated by CMake, see cpp_solvers/CMakeLists.txt
+#if __has_include(<solver_versions.hpp>)
+#include <solver_versions.hpp>
+#define AOC_HAS_SOLVER_VERSIONS
+#endif
+
+namespace fs = std::filesystem;
+
+namespace aoc {
+
+namespace {
+
+class Fnv1a {
+public:
+  void update(const char *data, std::size_t size) {
+    for (auto i = std::size_t(0); i < size; ++i) {
+      m_state ^= static_cast<unsigned char>(data[i]);
+      m_state *= 0x100000001b3ull;
+    }
+  }
+
+  std::string hex() const {
+    auto stream = std::stringstream();
+    stream << std::hex;
+    stream.width(16);
+    stream.fill('0');
+    stream << m_state;
+    return stream.str();
+  }
+
+private:
+  std::uint64_t m_state{0xcbf29ce484222325ull};
+};
+
+std::optional<std::string> readFile(const fs::path &path) {
+  auto file = std::ifstream(path, std::ios::binary);
+  if (not file) {
+    return std::nullopt;
+  }
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+// Writes to a temporary file first so that concurrent readers never see a
+// partially written entry
+void writeFile(const fs::path &path, const std::string &data) {
+  fs::create_directories(path.parent_path());
+  static auto nb_writes = std::atomic<std::uint64_t>{0};
+  auto tmp_path = path;
+  tmp_path += ".tmp" +
+              std::to_string(
+                  std::hash<std::thread::id>()(std::this_thread::get_id())) +
+              "-" + std::to_string(nb_writes++);
+  {
+    auto file = std::ofstream(tmp_path, std::ios::binary | std::ios::trunc);
+    if (not file) {
+      throw std::runtime_error("cannot write cache file \"" +
+                               tmp_path.string() + "\"");
+    }
+    file << data;
+  }
+  fs::rename(tmp_path, path);
+}
+
+std::string twoDigits(int value) {
+  return (value < 10 ? "0" : "") + std::to_string(value);
+}
+
+// Front ends read inputs from files, HTTP replies or text widgets, which do
+// not agree on trailing newlines: they are dropped so that the same input
+// always hashes the same
+std::string normalizedInput(const std::string &input) {
+  auto size = input.size();
+  while (size > 0 and (input[size - 1] == '\n' or input[size - 1] == '\r')) {
+    --size;
+  }
+  return input.substr(0, size);
+}
+
+// Year and day of an answer path <root>/answers/<year>/<day>/<part>/<file>
+std::optional<std::pair<int, int>> answerDay(const fs::path &path) {
+  const auto day_dir = path.parent_path().parent_path();
+  const auto year_dir = day_dir.parent_path();
+  try {
+    return std::make_pair(std::stoi(year_dir.filename().string()),
+                          std::stoi(day_dir.filename().string()));
+  } catch (const std::exception &) {
+    return std::nullopt;
+  }
+}
+
+} // namespace
+
+std::string contentHash(const std::string &data) {
+  auto hash = Fnv1a();
+  hash.update(data.data(), data.size());
+  return hash.hex();
+}
+
+std::optional<std::string> solverVersion([[maybe_unused]] int year,
+                                         [[maybe_unused]] int day) {
+#ifdef AOC_HAS_SOLVER_VERSIONS
+  for (const auto &version : solver_versions) {
+    if (version.year == year and version.day == day) {
+      return version.digest;
+    }
+  }
+#endif
+  return std::nullopt;
+}
+
+/******************************************************************************/
+
+Cache::Cache(const fs::path &root) : m_root{root} {}
+
+fs::path Cache::defaultRoot() {
+  if (const auto *dir = std::getenv("AOC_CACHE_DIR")) {
+    return fs::path(dir);
+  }
+  const auto *home = std::getenv("HOME");
+  return fs::path(home ? home : ".") / ".config" / "AdventOfCode" / "cache";
+}
+
+std::string Cache::storeInput(int year, int day,
+                              const std::string &input) const {
+  const auto normalized = normalizedInput(input);
+  const auto hash = contentHash(normalized);
+  const auto path = m_root / "inputs" / (hash + ".txt");
+  if (not fs::exists(path)) {
+    writeFile(path, normalized);
+  }
+  writeFile(m_root / "inputs" / std::to_string(year) / twoDigits(day), hash);
+  return hash;
+}
+
+std::optional<std::string> Cache::input(int year, int day) const {
+  const auto hash =
+      readFile(m_root / "inputs" / std::to_string(year) / twoDigits(day));
+  if (not hash) {
+    return std::nullopt;
+  }
+  return readFile(m_root / "inputs" / (*hash + ".txt"));
+}
+
+std::optional<fs::path> Cache::answerPath(int year, int day, int part,
+                                          const std::string &input) const {
+  const auto version = solverVersion(year, day);
+  if (not version) {
+    return std::nullopt;
+  }
+  return m_root / "answers" / std::to_string(year) / twoDigits(day) /
+         std::to_string(part) /
+         (contentHash(normalizedInput(input)) + "-" + *version + ".txt");
+}
+
+void Cache::storeAnswer(int year, int day, int part, const std::string &input,
+                        const std::string &answer) const {
+  if (const auto path = answerPath(year, day, part, input)) {
+    writeFile(*path, answer);
+  }
+}
+
+std::optional<std::string> Cache::answer(int year, int day, int part,
+                                         const std::string &input) const {
+  const auto path = answerPath(year, day, part, input);
+  if (not path) {
+    return std::nullopt;
+  }
+  return readFile(*path);
+}
+
+std::size_t Cache::removeStaleAnswers() const {
+  const auto answers_path = m_root / "answers";
+  if (not fs::exists(answers_path)) {
+    return 0;
+  }
+  auto stale = std::deque<fs::path>();
+  for (const auto &entry : fs::recursive_directory_iterator(answers_path)) {
+    if (not entry.is_regular_file()) {
+      continue;
+    }
+    const auto day = answerDay(entry.path());
+    const auto version =
+        day ? solverVersion(day->first, day->second) : std::nullopt;
+    const auto filename = entry.path().filename().string();
+    const auto suffix = version ? "-" + *version + ".txt" : "";
+    if (not version or filename.size() < suffix.size() or
+        filename.compare(filename.size() - suffix.size(), suffix.size(),
+                         suffix) != 0) {
+      stale.push_back(entry.path());
+    }
+  }
+  for (const auto &path : stale) {
+    fs::remove(path);
+  }
+  return stale.size();
+}
+
+} // namespace aoc
@@ -2,26 +2,24 @@
 
 namespace aoc {
 
+namespace {
+
+template <typename T>
+std::deque<T> splitAndParse(const std::string &str, char delimiter) {
+  auto result = std::deque<T>();
+  for (const auto token : tokens(str, delimiter)) {
+    result.emplace_back(parse<T>(token));
+  }
+  return result;
+}
+
+} // namespace
+
 std::deque<std::string> split(const std::string &str, char delimiter,
                               bool remove_empty) {
-
   auto result = std::deque<std::string>();
-  const auto n = std::size(str);
-  auto pos = std::size_t(0);
-  auto len = std::size_t(0);
-  while (pos + len < n) {
-    if (str[pos + len] == delimiter) {
-      if (not remove_empty or len > std::size_t(0)) {
-        result.emplace_back(str.substr(pos, len));
-      }
-      pos = pos + len + std::size_t(1);
-      len = std::size_t(0);
-    } else {
-      ++len;
-    }
-  }
-  if (str.back() != delimiter and (not remove_empty or len > std::size_t(0))) {
-    result.emplace_back(str.substr(pos, len));
+  for (const auto token : tokens(str, delimiter, remove_empty)) {
+    result.emplace_back(token);
   }
   return result;
 }
@@ -31,87 +29,47 @@ std::deque<std::string> splitLines(const std::string &str, bool remove_empty) {
 }
 
 std::deque<short int> splitToShortInt(const std::string &str, char delimiter) {
-  auto result = std::deque<short int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toShortInt(substr));
-  }
-  return result;
+  return splitAndParse<short int>(str, delimiter);
 }
 
 std::deque<int> splitToInt(const std::string &str, char delimiter) {
-  auto result = std::deque<int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toInt(substr));
-  }
-  return result;
+  return splitAndParse<int>(str, delimiter);
 }
 
 std::deque<long int> splitToLongInt(const std::string &str, char delimiter) {
-  auto result = std::deque<long int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toLongInt(substr));
-  }
-  return result;
+  return splitAndParse<long int>(str, delimiter);
 }
 
 std::deque<long long int> splitToLongLongInt(const std::string &str,
                                              char delimiter) {
-  auto result = std::deque<long long int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toLongLongInt(substr));
-  }
-  return result;
+  return splitAndParse<long long int>(str, delimiter);
 }
 
 std::deque<unsigned short int> splitToUShortInt(const std::string &str,
                                                 char delimiter) {
-  auto result = std::deque<unsigned short int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toUShortInt(substr));
-  }
-  return result;
+  return splitAndParse<unsigned short int>(str, delimiter);
 }
 
 std::deque<unsigned int> splitToUInt(const std::string &str, char delimiter) {
-  auto result = std::deque<unsigned int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toUInt(substr));
-  }
-  return result;
+  return splitAndParse<unsigned int>(str, delimiter);
 }
 
 std::deque<unsigned long int> splitToULongInt(const std::string &str,
                                               char delimiter) {
-  auto result = std::deque<unsigned long int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toULongInt(substr));
-  }
-  return result;
+  return splitAndParse<unsigned long int>(str, delimiter);
 }
 
 std::deque<unsigned long long int> splitToULongLongInt(const std::string &str,
                                                        char delimiter) {
-  auto result = std::deque<unsigned long long int>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toULongLongInt(substr));
-  }
-  return result;
+  return splitAndParse<unsigned long long int>(str, delimiter);
 }
 
 std::deque<float> splitToFloat(const std::string &str, char delimiter) {
-  auto result = std::deque<float>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toFloat(substr));
-  }
-  return result;
+  return splitAndParse<float>(str, delimiter);
 }
 
 std::deque<double> splitToDouble(const std::string &str, char delimiter) {
-  auto result = std::deque<double>();
-  for (const auto &substr : split(str, delimiter)) {
-    result.emplace_back(toDouble(substr));
-  }
-  return result;
+  return splitAndParse<double>(str, delimiter);
 }
 
 } // namespace aoc
@@ -11,6 +11,7 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QTextStream>
+#include <algorithm>
 #include <gui/jsonhelper.h>
 #include <iso646.h>
 #include <set>
@@ -200,6 +201,7 @@ void Configuration::setCookies(QNetworkRequest &request) const {
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow) {
   ui->setupUi(this);
+  ui->m_progress_bar_solver->setVisible(false);
   m_icon = QIcon(":/icon.png");
   this->setWindowIcon(m_icon);
 
@@ -263,10 +265,26 @@ void MainWindow::onSolved(const QString &output) {
                SLOT(onOutputReceived(QString)));
     disconnect(m_running_solver, SIGNAL(finished(QString)), this,
                SLOT(onSolved(QString)));
+    disconnect(m_running_solver, SIGNAL(progress(qint64, qint64)), this,
+               SLOT(onProgress(qint64, qint64)));
+    disconnect(m_running_solver, SIGNAL(cancelled()), this,
+               SLOT(onCancelled()));
+    if (not m_running_solver->requiresGuiThread() and
+        not m_running_solver->cancellationRequested() and
+        not output.startsWith("ERROR")) {
+      try {
+        m_cache.storeAnswer(m_running_year, m_running_day, m_running_puzzle,
+                            m_running_input.toStdString(),
+                            output.toStdString());
+      } catch (const std::exception &e) {
+        onOutputReceived(QString("Cannot cache answer: %1").arg(e.what()));
+      }
+    }
     m_running_solver = nullptr;
   }
   ui->m_push_button_solve->setText("SOLVE");
   ui->m_push_button_solve->setEnabled(true);
+  ui->m_progress_bar_solver->setVisible(false);
   ui->m_plain_text_edit_solver_output->clear();
   ui->m_plain_text_edit_solver_output->appendPlainText(output);
   ui->m_plain_text_edit_solver_output->moveCursor(QTextCursor::Start);
@@ -287,6 +305,16 @@ void MainWindow::replyFinished(QNetworkReply *reply) {
     ui->m_plain_text_edit_input->moveCursor(QTextCursor::Start);
     ui->m_plain_text_edit_input->ensureCursorVisible();
     ui->m_check_box_use_last_input->setChecked(true);
+    if (reply->error() == QNetworkReply::NoError) {
+      try {
+        m_cache.storeInput(ui->m_spin_box_year->value(),
+                           ui->m_spin_box_day->value(),
+                           ui->m_plain_text_edit_input->toPlainText()
+                               .toStdString());
+      } catch (const std::exception &e) {
+        onOutputReceived(QString("Cannot cache input: %1").arg(e.what()));
+      }
+    }
     QFile file(m_dir_path + "last_input.txt");
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
       QTextStream out(&file);
@@ -319,8 +347,14 @@ void MainWindow::replyFinished(QNetworkReply *reply) {
 }
 
 void MainWindow::on_m_push_button_solve_clicked() {
-  if (m_running_solver)
+  if (m_running_solver) {
+    if (m_running_solver->isRunning()) {
+      m_running_solver->cancel();
+      ui->m_push_button_solve->setText("CANCELLING");
+      ui->m_push_button_solve->setEnabled(false);
+    }
     return;
+  }
 
   m_display.hide();
   m_display.scene()->clear();
@@ -349,7 +383,8 @@ void MainWindow::on_m_push_button_solve_clicked() {
   ui->m_push_button_solve->setText("RUNNING");
   ui->m_push_button_solve->setEnabled(false);
   if (!ui->m_check_box_use_last_input->isChecked()) {
-    downloadPuzzleInput();
+    if (not loadCachedInput())
+      downloadPuzzleInput();
   } else {
     QFile file(m_dir_path + "last_input.txt");
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -524,7 +559,25 @@ void MainWindow::onOutputReceived(const QString &output) {
   ui->m_plain_text_edit_program_output->ensureCursorVisible();
 }
 
+void MainWindow::onProgress(qint64 current, qint64 total) {
+  if (total <= 0) {
+    ui->m_progress_bar_solver->setRange(0, 0);
+  } else {
+    ui->m_progress_bar_solver->setRange(0, 1000);
+    ui->m_progress_bar_solver->setValue(
+        static_cast<int>(1000 * std::min(current, total) / total));
+  }
+  ui->m_progress_bar_solver->setVisible(true);
+}
+
+void MainWindow::onCancelled() {
+  if (m_running_solver)
+    onSolved("CANCELLED");
+}
+
 void MainWindow::closeEvent(QCloseEvent *event) {
+  if (m_running_solver)
+    m_running_solver->cancel();
   m_display.close();
   event->accept();
 }
@@ -666,19 +719,65 @@ void MainWindow::saveConfig() {
 }
 
 void MainWindow::solve() {
-  m_running_solver =
-      m_solvers(ui->m_spin_box_year->value(), ui->m_spin_box_day->value(),
-                ui->m_spin_box_puzzle->value());
+  // The spin boxes may change while the solver runs, so the answer is cached
+  // under the puzzle that was actually solved
+  m_running_year = ui->m_spin_box_year->value();
+  m_running_day = ui->m_spin_box_day->value();
+  m_running_puzzle = ui->m_spin_box_puzzle->value();
+  m_running_solver = m_solvers(m_running_year, m_running_day, m_running_puzzle);
+  m_running_input = ui->m_plain_text_edit_input->toPlainText();
+  if (m_running_solver and not m_running_solver->requiresGuiThread()) {
+    const auto answer =
+        m_cache.answer(m_running_year, m_running_day, m_running_puzzle,
+                       m_running_input.toStdString());
+    if (answer) {
+      m_running_solver = nullptr;
+      onOutputReceived("Answer read from cache");
+      onSolved(QString::fromStdString(*answer));
+      return;
+    }
+  }
   if (m_running_solver) {
     connect(m_running_solver, SIGNAL(output(QString)), this,
             SLOT(onOutputReceived(QString)));
     connect(m_running_solver, SIGNAL(finished(QString)), this,
             SLOT(onSolved(QString)));
-    m_running_solver->solve(ui->m_plain_text_edit_input->toPlainText());
+    connect(m_running_solver, SIGNAL(progress(qint64, qint64)), this,
+            SLOT(onProgress(qint64, qint64)));
+    connect(m_running_solver, SIGNAL(cancelled()), this, SLOT(onCancelled()));
+    m_running_solver->start(m_running_input);
+    if (m_running_solver and m_running_solver->isRunning()) {
+      ui->m_push_button_solve->setText("CANCEL");
+      ui->m_push_button_solve->setEnabled(true);
+    }
   } else
     onSolved("Not Implemented");
 }
 
+bool MainWindow::loadCachedInput() {
+  const auto input = m_cache.input(ui->m_spin_box_year->value(),
+                                   ui->m_spin_box_day->value());
+  if (not input)
+    return false;
+  ui->m_plain_text_edit_input->clear();
+  ui->m_plain_text_edit_input->appendPlainText(QString::fromStdString(*input));
+  ui->m_plain_text_edit_input->moveCursor(QTextCursor::Start);
+  ui->m_plain_text_edit_input->ensureCursorVisible();
+  ui->m_check_box_use_last_input->setChecked(true);
+  QFile file(m_dir_path + "last_input.txt");
+  if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QTextStream out(&file);
+    out << ui->m_plain_text_edit_input->toPlainText();
+    file.close();
+  }
+  try {
+    solve();
+  } catch (const std::exception &e) {
+    onSolved(QString("ERROR: %1").arg(e.what()));
+  }
+  return true;
+}
+
 void MainWindow::downloadPuzzleInput() {
   m_puzzle_requested = true;
   QNetworkRequest request;
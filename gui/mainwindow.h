@@ -5,6 +5,7 @@
 #include <QMessageBox>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <cache.hpp>
 #include <gui/display/display.h>
 #include <gui/jsonhelper.h>
 #include <gui/leaderboard.h>
@@ -72,6 +73,8 @@ private slots:
                                                         int, int);
   void updateDisplay(const DisplayData &data);
   void onOutputReceived(const QString &output);
+  void onProgress(qint64 current, qint64 total);
+  void onCancelled();
   void closeEvent(QCloseEvent *event);
 
 private:
@@ -83,6 +86,7 @@ private:
   void saveConfig();
   void solve();
   void downloadPuzzleInput();
+  bool loadCachedInput();
   QString createDefault();
   bool setSources();
   BoardConf &getCurrentBoardConf(QString *ret_id = nullptr);
@@ -94,6 +98,11 @@ private:
   QNetworkAccessManager *m_manager;
   Solvers m_solvers;
   Solver *m_running_solver{nullptr};
+  QString m_running_input{};
+  int m_running_year{0};
+  int m_running_day{0};
+  int m_running_puzzle{0};
+  aoc::Cache m_cache{};
   Configuration m_config;
   QString m_dir_path;
   QString m_last_selected{""};
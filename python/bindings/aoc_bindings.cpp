@@ -52,6 +52,19 @@ std::string resultToString(const std::shared_ptr<aoc::Result> &result) {
                          : "failure";
 }
 
+aoc::Result solveCached(int year, int day, const std::string &input) {
+  return aoc::solveCached(year, day, input);
+}
+
+bp::object cachedInput(int year, int day) {
+  const auto input = aoc::Cache().input(year, day);
+  return input ? bp::object(*input) : bp::object();
+}
+
+void storeInput(int year, int day, const std::string &input) {
+  aoc::Cache().storeInput(year, day, input);
+}
+
 } // namespace aoc_bindings
 
 BOOST_PYTHON_MODULE(aoc) {
@@ -93,4 +106,7 @@ BOOST_PYTHON_MODULE(aoc) {
 
   bp::def("has_solver", &aoc::hasSolver);
   bp::def("solve", &aoc::solve);
+  bp::def("solve_cached", &aoc_bindings::solveCached);
+  bp::def("cached_input", &aoc_bindings::cachedInput);
+  bp::def("store_input", &aoc_bindings::storeInput);
 }
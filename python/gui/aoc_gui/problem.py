@@ -1,5 +1,6 @@
 from bs4 import BeautifulSoup
 from .paths import get_absolute_path
+from .solver import cached_input, store_input
 from .wget import DOMAIN_NAME, get_url
 
 ANSWER_FIRST_TEXT = "Your puzzle answer was"
@@ -37,15 +38,18 @@ class Problem:
     def refresh(self):
         self.clear()
 
-        input_response = get_url(
-            f"https://{DOMAIN_NAME}/{self.year}/day/{self.day}/input"
-        )
-        if input_response is None:
-            self.aoc_personal_input = "Error: timeout"
-        elif input_response.status_code == 200:
-            self.aoc_personal_input = input_response.text
-        else:
-            self.aoc_personal_input = f"Error: {input_response.status_code}"
+        self.aoc_personal_input = cached_input(self.year, self.day)
+        if self.aoc_personal_input is None:
+            input_response = get_url(
+                f"https://{DOMAIN_NAME}/{self.year}/day/{self.day}/input"
+            )
+            if input_response is None:
+                self.aoc_personal_input = "Error: timeout"
+            elif input_response.status_code == 200:
+                self.aoc_personal_input = input_response.text
+                store_input(self.year, self.day, self.aoc_personal_input)
+            else:
+                self.aoc_personal_input = f"Error: {input_response.status_code}"
 
         problem_response = get_url(f"https://{DOMAIN_NAME}/{self.year}/day/{self.day}")
         if problem_response is None:
@@ -8,4 +8,12 @@ import aoc
 
 
 def solve(year, day, input):
-    return aoc.solve(year, day, input)
+    return aoc.solve_cached(year, day, input)
+
+
+def cached_input(year, day):
+    return aoc.cached_input(year, day)
+
+
+def store_input(year, day, input):
+    aoc.store_input(year, day, input)
@@ -1,37 +1,32 @@
-#include <QCryptographicHash>
 #include <solvers/2015/puzzle_2015_04.h>
 #include <solvers/common.h>
+#include <solvers/md5search.h>
 
-#include <iostream>
+#include <functional>
+#include <optional>
 
-using Int = unsigned long long int;
-
-inline QString hash(const QString &input) {
-  return QString(
-      QCryptographicHash::hash(QByteArray(input.toStdString().c_str()),
-                               QCryptographicHash::Md5)
-          .toHex());
-}
-
-inline bool isValid(const QString &input, Int value,
-                    const QString &starts_with) {
-  return hash(input + QString("%1").arg(value)).startsWith(starts_with);
-}
-
-inline QString smallestValid(const QString &input, const QString &starts_with) {
+inline std::optional<QString>
+smallestValid(const QString &input, unsigned int nb_zeros,
+              const std::function<bool()> &cancelled) {
   auto copy = input;
   copy.remove('\n');
-  auto i = Int{0};
-  while (not isValid(copy, i, starts_with)) {
-    ++i;
-  }
-  return QString("%1").arg(i);
+  const auto search = common::Md5Search(copy.toStdString(), nb_zeros);
+  const auto hit = search.smallest(0, cancelled);
+  if (not hit)
+    return std::nullopt;
+  return QString::number(hit->nonce);
 }
 
 void Solver_2015_04_1::solve(const QString &input) {
-  emit finished(smallestValid(input, "00000"));
+  const auto res =
+      smallestValid(input, 5, [this]() { return cancellationRequested(); });
+  if (res)
+    emit finished(*res);
 }
 
 void Solver_2015_04_2::solve(const QString &input) {
-  emit finished(smallestValid(input, "000000"));
+  const auto res =
+      smallestValid(input, 6, [this]() { return cancellationRequested(); });
+  if (res)
+    emit finished(*res);
 }
@@ -1,7 +1,9 @@
-#include <QSet>
-#include <optional>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <solvers/2015/puzzle_2015_06.h>
 #include <solvers/common.h>
+#include <vector>
 
 using Int = unsigned long long int;
 
@@ -34,85 +36,126 @@ struct Instruction {
   uint ymax{0};
 };
 
-inline QString makeLight(uint x, uint y) {
-  return QString("%1%2").arg(x, 3, 10, QChar('0')).arg(y, 3, 10, QChar('0'));
+// Valid instructions whose rectangles are not empty, checked against the
+// grid dimensions
+std::vector<Instruction> parseInstructions(const QString &input, uint width,
+                                           uint height) {
+  auto instructions = std::vector<Instruction>();
+  for (const auto &line : common::splitLines(input)) {
+    const auto instruction = Instruction{line};
+    if (not instruction.valid or instruction.xmin > instruction.xmax or
+        instruction.ymin > instruction.ymax)
+      continue;
+    if (instruction.xmax >= width or instruction.ymax >= height)
+      common::throwInvalidArgumentError(
+          QString("Instruction \"%1\" is out of the %2x%3 grid")
+              .arg(line)
+              .arg(width)
+              .arg(height));
+    instructions.push_back(instruction);
+  }
+  return instructions;
 }
 
+// One bit per light, each row starting on a new word so that a rectangle is
+// a span of whole words on every row, with partial words at both ends
 class ChristmasLights_V1 {
 public:
-  ChristmasLights_V1(const QString &instructions) {
-    const auto lines = common::splitLines(instructions);
-    for (const auto &line : lines) {
-      const auto instruction = Instruction{line};
-      if (instruction.valid) {
-        for (auto x = instruction.xmin; x <= instruction.xmax; ++x) {
-          for (auto y = instruction.ymin; y <= instruction.ymax; ++y) {
-            const auto light = makeLight(x, y);
-            if (instruction.type == Instruction::Type::TOGGLE) {
-              if (m_grid.contains(light))
-                m_grid.remove(light);
-              else
-                m_grid.insert(light);
-            } else {
-              if (instruction.type == Instruction::Type::TURN_ON)
-                m_grid.insert(light);
-              else
-                m_grid.remove(light);
-            }
-          }
-        }
-      }
+  ChristmasLights_V1(const QString &instructions, uint width = 1000,
+                     uint height = 1000)
+      : m_nb_words_per_row{(width + word_size - 1) / word_size},
+        m_grid(std::size_t{m_nb_words_per_row} * height, Word{0}) {
+    for (const auto &instruction :
+         parseInstructions(instructions, width, height)) {
+      if (instruction.type == Instruction::Type::TURN_ON)
+        apply(instruction, [](Word word, Word mask) { return word | mask; });
+      else if (instruction.type == Instruction::Type::TURN_OFF)
+        apply(instruction, [](Word word, Word mask) { return word & ~mask; });
+      else
+        apply(instruction, [](Word word, Word mask) { return word ^ mask; });
     }
   }
 
-  QString nbLit() const { return QString("%1").arg(m_grid.size()); }
+  QString nbLit() const {
+    auto nb_lit = Int{0};
+    for (const auto word : m_grid)
+      nb_lit += std::bitset<word_size>(word).count();
+    return QString("%1").arg(nb_lit);
+  }
 
 private:
-  QSet<QString> m_grid;
+  using Word = std::uint64_t;
+  static constexpr auto word_size = 64u;
+
+  template <typename Operation>
+  void apply(const Instruction &instruction, Operation operation) {
+    const auto first = instruction.xmin / word_size;
+    const auto last = instruction.xmax / word_size;
+    const auto first_mask = ~Word{0} << (instruction.xmin % word_size);
+    const auto last_mask =
+        ~Word{0} >> (word_size - 1 - instruction.xmax % word_size);
+    for (auto y = instruction.ymin; y <= instruction.ymax; ++y) {
+      auto *row = m_grid.data() + std::size_t{y} * m_nb_words_per_row;
+      if (first == last) {
+        row[first] = operation(row[first], first_mask & last_mask);
+        continue;
+      }
+      row[first] = operation(row[first], first_mask);
+      for (auto w = first + 1; w < last; ++w)
+        row[w] = operation(row[w], ~Word{0});
+      row[last] = operation(row[last], last_mask);
+    }
+  }
+
+  uint m_nb_words_per_row;
+  std::vector<Word> m_grid;
 };
 
+// Dense brightness grid, updated one row span at a time with loops simple
+// enough to be vectorised. Brightnesses fit in 16 bits as long as there are
+// fewer than 32768 instructions.
 class ChristmasLights_V2 {
 public:
-  ChristmasLights_V2(const QString &instructions) {
-    const auto lines = common::splitLines(instructions);
-    for (const auto &line : lines) {
-      const auto instruction = Instruction{line};
-      if (instruction.valid) {
-        const auto decrease = instruction.type == Instruction::Type::TURN_OFF;
-        const auto increase =
-            instruction.type != Instruction::Type::TOGGLE ? Int{1} : Int{2};
-        for (auto x = instruction.xmin; x <= instruction.xmax; ++x) {
-          for (auto y = instruction.ymin; y <= instruction.ymax; ++y) {
-            const auto light = makeLight(x, y);
-            auto it = m_grid.find(light);
-            if (decrease) {
-              if (it != std::end(m_grid)) {
-                if (it.value() == Int{1})
-                  m_grid.erase(it);
-                else
-                  --(it.value());
-              }
-            } else {
-              if (it == std::end(m_grid))
-                m_grid[light] = increase;
-              else
-                it.value() += increase;
-            }
-          }
-        }
-      }
+  ChristmasLights_V2(const QString &instructions, uint width = 1000,
+                     uint height = 1000)
+      : m_width{width}, m_grid(std::size_t{width} * height, Brightness{0}) {
+    const auto parsed_instructions =
+        parseInstructions(instructions, width, height);
+    if (std::size(parsed_instructions) >= 32768)
+      common::throwInvalidArgumentError(
+          "ChristmasLights_V2: too many instructions");
+    for (const auto &instruction : parsed_instructions) {
+      if (instruction.type == Instruction::Type::TURN_ON)
+        apply(instruction, [](Brightness b) { return b + 1; });
+      else if (instruction.type == Instruction::Type::TURN_OFF)
+        apply(instruction, [](Brightness b) { return b - (b != 0); });
+      else
+        apply(instruction, [](Brightness b) { return b + 2; });
     }
   }
 
   QString totalBrightness() const {
     auto total_brightness = Int{0};
-    for (const auto &brightness : m_grid)
+    for (const auto brightness : m_grid)
       total_brightness += brightness;
     return QString("%1").arg(total_brightness);
   }
 
 private:
-  QMap<QString, Int> m_grid;
+  using Brightness = std::uint16_t;
+
+  template <typename Operation>
+  void apply(const Instruction &instruction, Operation operation) {
+    const auto size = instruction.xmax - instruction.xmin + 1;
+    for (auto y = instruction.ymin; y <= instruction.ymax; ++y) {
+      auto *row = m_grid.data() + std::size_t{y} * m_width + instruction.xmin;
+      for (auto x = 0u; x < size; ++x)
+        row[x] = static_cast<Brightness>(operation(row[x]));
+    }
+  }
+
+  uint m_width;
+  std::vector<Brightness> m_grid;
 };
 
 void Solver_2015_06_1::solve(const QString &input) {
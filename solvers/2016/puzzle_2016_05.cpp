@@ -1,61 +1,33 @@
 #include <solvers/2016/puzzle_2016_05.h>
 #include <solvers/common.h>
-#include <solvers/qchar_hash.hpp>
-
-#include <QCryptographicHash>
+#include <solvers/md5search.h>
 
 namespace puzzle_2016_05 {
 
-using Int = unsigned long long;
-
-const auto hexchar_to_position = std::unordered_map<QChar, ushort>{
-    {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3},
-    {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7},
-};
-
-inline std::optional<ushort> getPosition(const QChar &c) {
-  const auto it = hexchar_to_position.find(c);
-  if (it == std::cend(hexchar_to_position)) {
-    return std::nullopt;
-  }
-  return it->second;
-}
-
-inline QString hash(const QString &door_id, Int index) {
-  return QString(QCryptographicHash::hash(
-                     QString("%1%2").arg(door_id).arg(index).toLatin1(),
-                     QCryptographicHash::Md5)
-                     .toHex());
-}
-
 inline QString getPasswordV1(const QString &door_id, int password_size) {
   auto password = QString();
-  for (auto index = Int{0}; password.size() < password_size; ++index) {
-    const auto md5_hash = hash(door_id, index);
-    if (md5_hash.startsWith("00000")) {
-      password.push_back(md5_hash[5]);
-    }
-  }
+  common::Md5Search(door_id.toStdString(), 5)
+      .run(0, [&password, password_size](const common::Md5Hit &hit) {
+        password.push_back(QChar(hit.hexDigit(5)));
+        return password.size() < password_size;
+      });
   return password;
 }
 
-inline QString getPasswordV2(const QString &door_id,
-                             std::size_t password_size) {
-  auto password = std::map<ushort, QChar>{};
-  for (auto index = Int{0}; std::size(password) < password_size; ++index) {
-    const auto md5_hash = hash(door_id, index);
-    if (md5_hash.startsWith("00000")) {
-      const auto position = getPosition(md5_hash[5]);
-      if (position.has_value()) {
-        password.insert(std::make_pair(*position, md5_hash[6]));
-      }
-    }
-  }
-  auto result = QString{};
-  for (const auto &[_, c] : password) {
-    result.push_back(c);
-  }
-  return result;
+inline QString getPasswordV2(const QString &door_id, int password_size) {
+  auto password = QString(password_size, QChar('_'));
+  auto nb_found = 0;
+  common::Md5Search(door_id.toStdString(), 5)
+      .run(0, [&](const common::Md5Hit &hit) {
+        const auto position = hit.hexDigit(5) - '0';
+        if (position >= 0 and position < password_size and
+            password[position] == '_') {
+          password[position] = QChar(hit.hexDigit(6));
+          ++nb_found;
+        }
+        return nb_found < password_size;
+      });
+  return password;
 }
 
 } // namespace puzzle_2016_05
@@ -1,5 +1,9 @@
-﻿#include <solvers/2018/puzzle_2018_09.h>
+﻿#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <solvers/2018/puzzle_2018_09.h>
 #include <solvers/common.h>
+#include <vector>
 
 namespace puzzle_2018_09 {
 
@@ -17,33 +21,55 @@ inline Int toInt(const QString &string) {
   return value;
 }
 
-struct Marble {
-  Marble(Int value = Int(0), Marble *previous = nullptr, Marble *next = nullptr)
-      : value{value}, previous{previous}, next{next} {
-    if (previous) {
-      previous->next = this;
-    } else {
-      this->previous = this;
-    }
-    if (next) {
-      next->previous = this;
-    } else {
-      this->next = this;
+// Circle stored clockwise in a preallocated ring buffer, the current marble
+// being the last one. Moving the current marble only moves the marbles at
+// both ends, so every operation touches contiguous memory. The buffer size is
+// a power of two larger than the capacity, so that indices wrap with a mask.
+class Circle {
+public:
+  Circle(std::size_t capacity) {
+    auto size = std::size_t{1};
+    while (size <= capacity) {
+      size *= 2;
     }
+    m_marbles.resize(size);
+    m_mask = size - 1;
   }
 
-  Int value;
-  Marble *previous;
-  Marble *next;
-};
+  void pushBack(std::uint32_t marble) {
+    m_marbles[index(m_size)] = marble;
+    ++m_size;
+  }
+
+  std::uint32_t popBack() {
+    --m_size;
+    return m_marbles[index(m_size)];
+  }
+
+  void rotateClockwise() {
+    m_marbles[index(m_size)] = m_marbles[m_head];
+    m_head = index(1);
+  }
+
+  void rotateCounterClockwise() {
+    m_head = (m_head - 1) & m_mask;
+    m_marbles[m_head] = m_marbles[index(m_size)];
+  }
+
+private:
+  std::size_t index(std::size_t offset) const {
+    return (m_head + offset) & m_mask;
+  }
 
-struct Player {
-  Int score{0u};
+  std::vector<std::uint32_t> m_marbles;
+  std::size_t m_mask{0};
+  std::size_t m_head{0};
+  std::size_t m_size{0};
 };
 
 class Game {
 public:
-  Game(const QString &input, bool v2) {
+  Game(const QString &input, Int multiplier) {
     const auto first_line = common::splitLines(input, true).front();
     auto rx = QRegExp("^(\\d+) players; last marble is worth (\\d+) points$");
     if (not rx.exactMatch(first_line)) {
@@ -52,92 +78,62 @@ public:
               .arg(first_line));
     }
     m_nb_players = toInt(rx.cap(1));
-    m_last_marble_value = toInt(rx.cap(2));
-    if (v2) {
-      m_last_marble_value *= Int(100);
+    m_last_marble_value = toInt(rx.cap(2)) * multiplier;
+    if (m_nb_players == Int(0)) {
+      common::throwInvalidArgumentError(
+          "puzzle_2018_09::Game: there must be at least one player");
     }
-    m_players.resize(m_nb_players);
-    m_current_marble = new Marble();
-    ++m_nb_marbles;
-    run();
-  }
-
-  ~Game() {
-    while (m_nb_marbles != Int(0)) {
-      deleteCurrent();
+    if (m_last_marble_value >= std::numeric_limits<std::uint32_t>::max()) {
+      common::throwInvalidArgumentError(
+          QString("puzzle_2018_09::Game: too many marbles (%1)")
+              .arg(m_last_marble_value));
     }
+    m_scores.resize(m_nb_players, Int(0));
+    run();
   }
 
   QString maxScore() const {
-    auto max_score = Int(0);
-    for (const auto &player : m_players) {
-      max_score = std::max(max_score, player.score);
-    }
-    return QString("%1").arg(max_score);
+    const auto it =
+        std::max_element(std::cbegin(m_scores), std::cend(m_scores));
+    return QString("%1").arg(*it);
   }
 
 private:
-  void deleteCurrent() {
-    if (m_nb_marbles == Int(0)) {
-      common::throwRunTimeError("puzzle_2018_09::deleteCurrent: empty circle");
-    }
-    if (not m_current_marble) {
-      common::throwRunTimeError(
-          "puzzle_2018_09::deleteCurrent: current marble is nullptr");
-    }
-    --m_nb_marbles;
-    if (m_nb_marbles == Int(0)) {
-      delete m_current_marble;
-      m_current_marble = nullptr;
-      return;
-    }
-    auto *previous = m_current_marble->previous;
-    auto *next = m_current_marble->next;
-    previous->next = next;
-    next->previous = previous;
-    delete m_current_marble;
-    m_current_marble = next;
-  }
-
   void run() {
-    auto current_player_index = Int(0);
-    for (auto marble_value = Int(1); marble_value <= m_last_marble_value;
-         ++marble_value) {
-      if (marble_value % Int(23) == Int(0)) {
-        m_players[current_player_index].score += marble_value;
+    auto circle = Circle(m_last_marble_value + 1);
+    circle.pushBack(0u);
+    auto player = Int(0);
+    for (auto value = std::uint32_t{1}; value <= m_last_marble_value;
+         ++value) {
+      if (value % 23u == 0u) {
         for (auto i = 0; i < 7; ++i) {
-          m_current_marble = m_current_marble->previous;
+          circle.rotateCounterClockwise();
         }
-        m_players[current_player_index].score += m_current_marble->value;
-        deleteCurrent();
+        m_scores[player] += Int(value) + circle.popBack();
+        circle.rotateClockwise();
       } else {
-        auto *previous = m_current_marble->next;
-        auto *next = previous->next;
-        m_current_marble = new Marble(marble_value, previous, next);
-        ++m_nb_marbles;
+        circle.rotateClockwise();
+        circle.pushBack(value);
       }
-      ++current_player_index;
-      if (current_player_index >= m_nb_players) {
-        current_player_index = Int(0);
+      if (++player == m_nb_players) {
+        player = Int(0);
       }
     }
   }
 
-  Int m_nb_marbles{0};
   Int m_nb_players;
   Int m_last_marble_value;
-  std::vector<Player> m_players;
-  Marble *m_current_marble;
+  std::vector<Int> m_scores;
 };
 
 } // namespace puzzle_2018_09
 
 void Solver_2018_09_1::solve(const QString &input) {
-  const auto game = puzzle_2018_09::Game(input, false);
+  const auto game = puzzle_2018_09::Game(input, 1);
   emit finished(game.maxScore());
 }
 
 void Solver_2018_09_2::solve(const QString &input) {
-  const auto game = puzzle_2018_09::Game(input, true);
+  const auto game = puzzle_2018_09::Game(input, 100);
   emit finished(game.maxScore());
 }
@@ -1,123 +1,182 @@
+#include <algorithm>
 #include <solvers/2019/intcodecomputer.h>
 #include <solvers/common.h>
-#include <solvers/solvers.h>
+#include <stdexcept>
+#include <string>
 
 namespace event_2019 {
 
-Int State::get(const Int address, const QChar & /*mode*/) const {
-  const auto it = m_memory.constFind(address);
-  if (it == m_memory.cend()) {
-    common::throwInvalidArgumentError(
-        QString("event_2019::State::get: bad memory address %1").arg(address));
-  }
-  return *it;
-}
-
-void State::set(const Int address, const Int value) {
-  m_memory[address] = value;
+void throwNegativeAddress(const char *function, Int address) {
+  throw std::invalid_argument(std::string("event_2019::IntcodeComputer::") +
+                              function + ": negative address " +
+                              std::to_string(address));
 }
 
-Int State::pointer() const { return m_pointer; }
-
-void State::jump(const Int distance) { m_pointer += distance; }
-
-void State::goTo(const Int address) { m_pointer = address; }
-
-void State::reset(const QVector<Int> &values) {
-  m_pointer = Int(0);
-  m_memory.clear();
-  const auto size = static_cast<Int>(values.size());
-  for (auto address = 0u; address < size; ++address) {
-    m_memory[address] = values[address];
-  }
+void throwImmediateWrite(Int pointer) {
+  throw std::invalid_argument(
+      "event_2019::IntcodeComputer::address: immediate mode write parameter "
+      "at address " +
+      std::to_string(pointer));
 }
 
 /******************************************************************************/
 
-Instruction::Instruction(const Int nb_parameters)
-    : m_nb_parameters{nb_parameters} {}
-
-QVector<Int> Instruction::getParameters(const QString &parameters_modes,
-                                        const State &state) {
-  auto it_mode = parameters_modes.crbegin();
-  const auto get_next_mode = [&it_mode, &parameters_modes]() {
-    if (it_mode == parameters_modes.crend()) {
-      return QChar('0');
-    }
-    const auto mode = *it_mode;
-    ++it_mode;
-    return mode;
-  };
-  auto parameters = QVector<Int>();
-  parameters.reserve(m_nb_parameters);
-  for (auto i = Int(1); i <= m_nb_parameters; ++i) {
-    const auto mode = get_next_mode();
-    parameters << state.get(state.pointer() + i, mode);
-  }
-  return parameters;
+Int IntQueue::pop() {
+  if (empty())
+    throw std::runtime_error("event_2019::IntQueue::pop: empty queue");
+  const auto value = m_values[m_head];
+  if (++m_head == m_values.size())
+    clear();
+  return value;
 }
 
-/******************************************************************************/
-
-Addition::Addition() : Instruction{Int(3)} {}
-
-void Addition::apply(const QString &parameters_modes, State &state) {
-  const auto parameters = getParameters(parameters_modes, state);
-  state.set(parameters[2], parameters[0] + parameters[1]);
-  state.jump(Int(4));
+void IntQueue::clear() {
+  m_values.clear();
+  m_head = 0;
 }
 
 /******************************************************************************/
 
-Multiplication::Multiplication() : Instruction{Int(3)} {}
-
-void Multiplication::apply(const QString &parameters_modes, State &state) {
-  const auto parameters = getParameters(parameters_modes, state);
-  state.set(parameters[2], parameters[0] * parameters[1]);
-  state.jump(Int(4));
+IntcodeComputer::IntcodeComputer(const QString &input) {
+  const auto values = common::toVecLongLong(input.trimmed(), ',');
+  m_program.assign(std::cbegin(values), std::cend(values));
+  reset();
 }
 
-/******************************************************************************/
+IntcodeComputer::IntcodeComputer(std::vector<Int> program)
+    : m_program{std::move(program)} {
+  reset();
+}
 
-const auto instructions = QHash<QString, std::shared_ptr<Instruction>>{
-    {"01", std::make_shared<Addition>()},
-    {"02", std::make_shared<Multiplication>()}};
+void IntcodeComputer::reset() {
+  m_memory = m_program;
+  m_decoded.assign(m_memory.size(), Instruction());
+  m_inputs.clear();
+  m_outputs.clear();
+  m_pointer = 0;
+  m_relative_base = 0;
+  m_status = Status::Ready;
+  m_nb_executed = 0;
+}
 
-bool applyCurrent(State &state) {
-  auto parameters_modes =
-      QString("%1").arg(state.get(state.pointer(), '1'), 2, 10, QChar('0'));
-  const auto opcode = parameters_modes.mid(parameters_modes.size() - 2);
-  if (opcode == "99") {
-    return false;
-  }
-  const auto it = instructions.constFind(opcode);
-  if (it == instructions.cend()) {
-    common::throwInvalidArgumentError(
-        QString("event_2019::appyCurrent: unrecognized opcode \"%1\"")
-            .arg(opcode));
+void IntcodeComputer::set(Int address, Int value) {
+  if (static_cast<std::uint64_t>(address) >= m_memory.size()) {
+    if (address < 0)
+      throwNegativeAddress("set", address);
+    grow(address);
   }
-  parameters_modes.chop(2);
-  (*it)->apply(parameters_modes, state);
-  return true;
+  const auto index = static_cast<std::size_t>(address);
+  m_memory[index] = value;
+  m_decoded[index].opcode = 0;
 }
 
-/******************************************************************************/
-
-IntcodeComputer::IntcodeComputer(const QString &input)
-    : m_initial_memory{common::toVecULongLong(input, ',')} {
-  reset();
+void IntcodeComputer::pushInput(Int value) {
+  m_inputs.push(value);
+  if (m_status == Status::WaitingForInput)
+    m_status = Status::Ready;
 }
 
-const State &IntcodeComputer::state() const { return m_state; }
+void IntcodeComputer::grow(Int address) {
+  const auto size =
+      std::max(static_cast<std::size_t>(address) + 1, 2 * m_memory.size());
+  m_memory.resize(size, Int(0));
+  m_decoded.resize(size, Instruction());
+}
 
-void IntcodeComputer::reset() { m_state.reset(m_initial_memory); }
+const Instruction &IntcodeComputer::decode(Int address) {
+  if (static_cast<std::uint64_t>(address) < m_decoded.size()) {
+    const auto &instruction = m_decoded[static_cast<std::size_t>(address)];
+    if (instruction.opcode != 0)
+      return instruction;
+  }
+  return decodeMemory(address);
+}
 
-void IntcodeComputer::set(const Int address, const Int value) {
-  m_state.set(address, value);
+const Instruction &IntcodeComputer::decodeMemory(Int address) {
+  if (static_cast<std::uint64_t>(address) >= m_memory.size()) {
+    throw std::invalid_argument(
+        "event_2019::IntcodeComputer::decode: instruction pointer " +
+        std::to_string(address) + " out of memory");
+  }
+  auto &instruction = m_decoded[static_cast<std::size_t>(address)];
+  const auto value = m_memory[static_cast<std::size_t>(address)];
+  const auto opcode = value % 100;
+  if (value < 0 or not((opcode >= 1 and opcode <= 9) or opcode == 99)) {
+    throw std::invalid_argument(
+        "event_2019::IntcodeComputer::decode: unrecognized instruction " +
+        std::to_string(value) + " at address " + std::to_string(address));
+  }
+  instruction.opcode = static_cast<std::uint8_t>(opcode);
+  auto modes = value / 100;
+  for (auto &mode : instruction.modes) {
+    mode = static_cast<std::uint8_t>(modes % 10);
+    if (mode > 2) {
+      throw std::invalid_argument(
+          "event_2019::IntcodeComputer::decode: bad parameter mode in " +
+          std::to_string(value) + " at address " + std::to_string(address));
+    }
+    modes /= 10;
+  }
+  return instruction;
 }
 
-void IntcodeComputer::run() {
-  while (applyCurrent(m_state)) {
+Status IntcodeComputer::run() {
+  if (m_status == Status::Halted)
+    return m_status;
+  m_status = Status::Ready;
+  while (true) {
+    const auto instruction = decode(m_pointer);
+    switch (instruction.opcode) {
+    case 1:
+      set(address(instruction, 2),
+          read(instruction, 0) + read(instruction, 1));
+      m_pointer += 4;
+      break;
+    case 2:
+      set(address(instruction, 2),
+          read(instruction, 0) * read(instruction, 1));
+      m_pointer += 4;
+      break;
+    case 3:
+      if (m_inputs.empty())
+        return m_status = Status::WaitingForInput;
+      set(address(instruction, 0), m_inputs.pop());
+      m_pointer += 2;
+      break;
+    case 4:
+      if (m_next)
+        m_next->pushInput(read(instruction, 0));
+      else
+        m_outputs.push(read(instruction, 0));
+      m_pointer += 2;
+      break;
+    case 5:
+      m_pointer = read(instruction, 0) != 0 ? read(instruction, 1)
+                                            : m_pointer + 3;
+      break;
+    case 6:
+      m_pointer = read(instruction, 0) == 0 ? read(instruction, 1)
+                                            : m_pointer + 3;
+      break;
+    case 7:
+      set(address(instruction, 2),
+          read(instruction, 0) < read(instruction, 1) ? 1 : 0);
+      m_pointer += 4;
+      break;
+    case 8:
+      set(address(instruction, 2),
+          read(instruction, 0) == read(instruction, 1) ? 1 : 0);
+      m_pointer += 4;
+      break;
+    case 9:
+      m_relative_base += read(instruction, 0);
+      m_pointer += 2;
+      break;
+    default:
+      ++m_nb_executed;
+      return m_status = Status::Halted;
+    }
+    ++m_nb_executed;
   }
 }
 
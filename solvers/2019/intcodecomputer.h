@@ -1,76 +1,117 @@
 #pragma once
 
-#include <QHash>
 #include <QString>
+#include <cstdint>
+#include <vector>
 
 namespace event_2019 {
 
-using Int = unsigned long long;
-using Memory = QHash<Int, Int>;
+using Int = long long int;
 
 /******************************************************************************/
 
-class State {
+class IntQueue {
 public:
-  Int get(Int address, const QChar &) const;
-  void set(Int address, Int value);
-
-  Int pointer() const;
-  void jump(Int distance);
-  void goTo(Int address);
+  bool empty() const { return m_head == m_values.size(); }
+  std::size_t size() const { return m_values.size() - m_head; }
 
-  void reset(const QVector<Int> &values);
+  void push(Int value) { m_values.push_back(value); }
+  Int pop();
+  void clear();
 
 private:
-  Int m_pointer{0};
-  Memory m_memory{};
+  std::vector<Int> m_values{};
+  std::size_t m_head{0};
 };
 
 /******************************************************************************/
 
-class Instruction {
-public:
-  Instruction(Int nb_parameters);
-  virtual ~Instruction() = default;
-  QVector<Int> getParameters(const QString &parameters_modes,
-                             const State &state);
-  virtual void apply(const QString &parameters_modes, State &state) = 0;
-
-private:
-  Int m_nb_parameters;
+struct Instruction {
+  std::uint8_t opcode{0};
+  std::uint8_t modes[3]{0, 0, 0};
 };
 
-/******************************************************************************/
-
-class Addition : public Instruction {
-public:
-  Addition();
-  void apply(const QString &parameters_modes, State &state) final;
-};
-
-/******************************************************************************/
-
-class Multiplication : public Instruction {
-public:
-  Multiplication();
-  void apply(const QString &parameters_modes, State &state) final;
-};
+[[noreturn]] void throwNegativeAddress(const char *function, Int address);
+[[noreturn]] void throwImmediateWrite(Int pointer);
 
-/******************************************************************************/
+enum class Status { Ready, WaitingForInput, Halted };
 
 class IntcodeComputer {
 public:
   IntcodeComputer(const QString &input);
-
-  const State &state() const;
+  IntcodeComputer(std::vector<Int> program);
 
   void reset();
+
+  Int get(Int address) const;
   void set(Int address, Int value);
-  void run();
+
+  void pushInput(Int value);
+  IntQueue &outputs() { return m_outputs; }
+
+  // Outputs are written straight into the input queue of the next computer,
+  // which must outlive this one and stay at the same address
+  void pipeTo(IntcodeComputer &next) { m_next = &next; }
+
+  // Runs until the program halts or needs an input that is not queued yet
+  Status run();
+
+  Status status() const { return m_status; }
+  std::uint64_t nbExecutedInstructions() const { return m_nb_executed; }
 
 private:
-  QVector<Int> m_initial_memory;
-  State m_state;
+  const Instruction &decode(Int address);
+  const Instruction &decodeMemory(Int address);
+  Int read(const Instruction &instruction, int index) const;
+  Int address(const Instruction &instruction, int index) const;
+  void grow(Int address);
+
+  std::vector<Int> m_program;
+  std::vector<Int> m_memory{};
+  std::vector<Instruction> m_decoded{};
+  IntQueue m_inputs{};
+  IntQueue m_outputs{};
+  IntcodeComputer *m_next{nullptr};
+  Int m_pointer{0};
+  Int m_relative_base{0};
+  Status m_status{Status::Ready};
+  std::uint64_t m_nb_executed{0};
 };
 
+/******************************************************************************/
+
+inline Int IntcodeComputer::get(Int address) const {
+  if (static_cast<std::uint64_t>(address) < m_memory.size())
+    return m_memory[static_cast<std::size_t>(address)];
+  if (address < 0)
+    throwNegativeAddress("get", address);
+  return Int(0);
+}
+
+inline Int IntcodeComputer::read(const Instruction &instruction,
+                                 int index) const {
+  const auto parameter = get(m_pointer + 1 + index);
+  switch (instruction.modes[index]) {
+  case 0:
+    return get(parameter);
+  case 1:
+    return parameter;
+  default:
+    return get(m_relative_base + parameter);
+  }
+}
+
+inline Int IntcodeComputer::address(const Instruction &instruction,
+                                    int index) const {
+  const auto parameter = get(m_pointer + 1 + index);
+  switch (instruction.modes[index]) {
+  case 0:
+    return parameter;
+  case 2:
+    return m_relative_base + parameter;
+  default:
+    throwImmediateWrite(m_pointer);
+  }
+}
+
 } // namespace event_2019
@@ -1,6 +1,28 @@
+#include <solvers/2019/intcodecomputer.h>
 #include <solvers/2019/puzzle_2019_05.h>
 #include <solvers/common.h>
 
-void Solver_2019_05_1::solve(const QString &input) { emit finished(input); }
+namespace puzzle_2019_05 {
 
-void Solver_2019_05_2::solve(const QString &input) { emit finished(input); }
+using namespace event_2019;
+
+QString diagnosticCode(const QString &input, Int system_id) {
+  auto computer = IntcodeComputer(input);
+  computer.pushInput(system_id);
+  if (computer.run() != Status::Halted)
+    return "FAILURE: program is waiting for more inputs";
+  auto code = Int(0);
+  while (not computer.outputs().empty())
+    code = computer.outputs().pop();
+  return QString::number(code);
+}
+
+} // namespace puzzle_2019_05
+
+void Solver_2019_05_1::solve(const QString &input) {
+  emit finished(puzzle_2019_05::diagnosticCode(input, 1));
+}
+
+void Solver_2019_05_2::solve(const QString &input) {
+  emit finished(puzzle_2019_05::diagnosticCode(input, 5));
+}
@@ -1,6 +1,75 @@
+#include <algorithm>
+#include <array>
+#include <solvers/2019/intcodecomputer.h>
 #include <solvers/2019/puzzle_2019_07.h>
 #include <solvers/common.h>
 
-void Solver_2019_07_1::solve(const QString &input) { emit finished(input); }
+namespace puzzle_2019_07 {
 
-void Solver_2019_07_2::solve(const QString &input) { emit finished(input); }
+using namespace event_2019;
+
+constexpr auto nb_amplifiers = std::size_t{5};
+
+using Phases = std::array<Int, nb_amplifiers>;
+
+class Amplifiers {
+public:
+  Amplifiers(const QString &input) {
+    const auto values = common::toVecLongLong(input.trimmed(), ',');
+    m_program.assign(std::cbegin(values), std::cend(values));
+  }
+
+  Int thrusterSignal(const Phases &phases) const {
+    auto amplifiers = std::vector<IntcodeComputer>();
+    amplifiers.reserve(nb_amplifiers);
+    for (auto i = std::size_t{0}; i < nb_amplifiers; ++i) {
+      amplifiers.emplace_back(m_program);
+      amplifiers.back().pushInput(phases[i]);
+    }
+    for (auto i = std::size_t{0}; i + 1 < nb_amplifiers; ++i)
+      amplifiers[i].pipeTo(amplifiers[i + 1]);
+    amplifiers.front().pushInput(0);
+    auto &last = amplifiers.back();
+    auto signal = Int(0);
+    while (true) {
+      auto progress = false;
+      for (auto &amplifier : amplifiers) {
+        const auto executed = amplifier.nbExecutedInstructions();
+        amplifier.run();
+        progress = progress or amplifier.nbExecutedInstructions() != executed;
+      }
+      while (not last.outputs().empty()) {
+        signal = last.outputs().pop();
+        amplifiers.front().pushInput(signal);
+      }
+      if (last.status() == Status::Halted)
+        return signal;
+      if (not progress)
+        common::throwRunTimeError(
+            "puzzle_2019_07::Amplifiers: amplifiers are deadlocked");
+    }
+  }
+
+  QString maxThrusterSignal(Int first_phase) const {
+    auto phases = Phases();
+    for (auto i = std::size_t{0}; i < nb_amplifiers; ++i)
+      phases[i] = first_phase + static_cast<Int>(i);
+    auto max_signal = thrusterSignal(phases);
+    while (std::next_permutation(std::begin(phases), std::end(phases)))
+      max_signal = std::max(max_signal, thrusterSignal(phases));
+    return QString::number(max_signal);
+  }
+
+private:
+  std::vector<Int> m_program;
+};
+
+} // namespace puzzle_2019_07
+
+void Solver_2019_07_1::solve(const QString &input) {
+  emit finished(puzzle_2019_07::Amplifiers(input).maxThrusterSignal(0));
+}
+
+void Solver_2019_07_2::solve(const QString &input) {
+  emit finished(puzzle_2019_07::Amplifiers(input).maxThrusterSignal(5));
+}
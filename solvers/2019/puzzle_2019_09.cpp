@@ -1,6 +1,28 @@
+#include <solvers/2019/intcodecomputer.h>
 #include <solvers/2019/puzzle_2019_09.h>
 #include <solvers/common.h>
 
-void Solver_2019_09_1::solve(const QString &input) { emit finished(input); }
+namespace puzzle_2019_09 {
 
-void Solver_2019_09_2::solve(const QString &input) { emit finished(input); }
+using namespace event_2019;
+
+QString boostKeycode(const QString &input, Int mode) {
+  auto computer = IntcodeComputer(input);
+  computer.pushInput(mode);
+  if (computer.run() != Status::Halted)
+    return "FAILURE: program is waiting for more inputs";
+  auto outputs = QStringList();
+  while (not computer.outputs().empty())
+    outputs << QString::number(computer.outputs().pop());
+  return outputs.join(',');
+}
+
+} // namespace puzzle_2019_09
+
+void Solver_2019_09_1::solve(const QString &input) {
+  emit finished(puzzle_2019_09::boostKeycode(input, 1));
+}
+
+void Solver_2019_09_2::solve(const QString &input) {
+  emit finished(puzzle_2019_09::boostKeycode(input, 2));
+}
@@ -1,49 +1,92 @@
-#include <QMap>
 #include <QVector>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <solvers/2020/puzzle_2020_15.h>
 #include <solvers/common.h>
+#include <vector>
 
 namespace puzzle_2020_15 {
 
-struct Game {
+// Values below this bound are spoken again quickly and stay in cache. Above
+// it, most values are spoken for the first time, so a bitmap of the values
+// already spoken avoids a cache miss on the large turn table.
+constexpr auto dense_bound = std::uint32_t{1} << 16;
+
+class Game {
+public:
   Game(const QString &input) {
-    QVector<uint> start = common::toVecUInt(input);
-    for (const uint &i : start)
-      speak(i);
+    const auto start = common::toVecUInt(input.trimmed());
+    if (start.isEmpty())
+      common::throwInvalidArgumentError(
+          "puzzle_2020_15::Game: empty starting numbers");
+    m_start.assign(std::cbegin(start), std::cend(start));
   }
 
-  void speak(uint number) {
-    uint last_spoken_at = m_last_spoken_at.value(number, m_current_turn);
-    m_next = m_current_turn - last_spoken_at;
-    m_last_spoken_at[number] = m_current_turn;
-    ++m_current_turn;
-    m_last_spoken = number;
+  // Number spoken at the given turn (the first turn is turn 1). Stops and
+  // returns 0 as soon as cancelled(current_turn) returns true.
+  std::uint32_t
+  spokenAt(std::uint32_t turn,
+           const std::function<bool(std::uint32_t)> &cancelled = {}) const {
+    const auto nb_start = static_cast<std::uint32_t>(m_start.size());
+    if (turn == 0)
+      common::throwInvalidArgumentError("puzzle_2020_15::Game: turn 0");
+    if (turn <= nb_start)
+      return m_start[turn - 1];
+    const auto size =
+        std::max(turn, *std::max_element(std::cbegin(m_start),
+                                         std::cend(m_start)) + 1);
+    auto last_spoken_at = std::vector<std::uint32_t>(size, 0u);
+    auto spoken = std::vector<std::uint64_t>(size / 64 + 1, 0u);
+    for (auto i = std::uint32_t{0}; i + 1 < nb_start; ++i) {
+      last_spoken_at[m_start[i]] = i + 1;
+      spoken[m_start[i] >> 6] |= std::uint64_t{1} << (m_start[i] & 63);
+    }
+    auto current = m_start.back();
+    for (auto chunk = nb_start; chunk < turn; chunk += chunk_size) {
+      if (cancelled and cancelled(chunk))
+        return 0;
+      const auto chunk_end = chunk + std::min(chunk_size, turn - chunk);
+      for (auto t = chunk; t < chunk_end; ++t) {
+        auto previous = std::uint32_t{0};
+        if (current < dense_bound) {
+          previous = last_spoken_at[current];
+        } else {
+          auto &word = spoken[current >> 6];
+          const auto bit = std::uint64_t{1} << (current & 63);
+          if (word & bit)
+            previous = last_spoken_at[current];
+          else
+            word |= bit;
+        }
+        last_spoken_at[current] = t;
+        current = previous == 0 ? 0 : t - previous;
+      }
+    }
+    return current;
   }
 
-  void playNextTurn() { speak(m_next); }
+private:
+  static constexpr auto chunk_size = std::uint32_t{1} << 20;
 
-  uint m_next;
-  uint m_current_turn{0};
-  QMap<uint, uint> m_last_spoken_at{};
-  uint m_last_spoken;
+  std::vector<std::uint32_t> m_start;
 };
 
 } // namespace puzzle_2020_15
 
 void Solver_2020_15_1::solve(const QString &input) {
   using namespace puzzle_2020_15;
-  Game game(input);
-  while (game.m_current_turn < 2020) {
-    game.playNextTurn();
-  }
-  emit finished(QString::number(game.m_last_spoken));
+  emit finished(QString::number(Game(input).spokenAt(2020)));
 }
 
 void Solver_2020_15_2::solve(const QString &input) {
   using namespace puzzle_2020_15;
-  Game game(input);
-  while (game.m_current_turn < 30000000) {
-    game.playNextTurn();
-  }
-  emit finished(QString::number(game.m_last_spoken));
+  const auto nb_turns = std::uint32_t{30000000};
+  const auto spoken =
+      Game(input).spokenAt(nb_turns, [this, nb_turns](std::uint32_t turn) {
+        reportProgress(turn, nb_turns);
+        return cancellationRequested();
+      });
+  if (not cancellationRequested())
+    emit finished(QString::number(spoken));
 }
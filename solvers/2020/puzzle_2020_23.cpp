@@ -1,199 +1,96 @@
-#include <QDebug>
 #include <solvers/2020/puzzle_2020_23.h>
 #include <solvers/common.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace puzzle_2020_23 {
 
 using Int = unsigned long long int;
+using Label = std::uint32_t;
 
-struct Cup {
-  Cup(Int value) : m_value{value} {}
-  Int m_value{0};
-  Cup *m_previous{nullptr};
-  Cup *m_next{nullptr};
-
-  void debug() const {
-    QString prev =
-        m_previous ? QString::number(m_previous->m_value) : QString("null");
-    QString next =
-        m_previous ? QString::number(m_next->m_value) : QString("null");
-    qDebug() << "Cup" << m_value << "Prev" << prev.toStdString().c_str()
-             << "Next" << next.toStdString().c_str();
-  }
-};
-
-struct CupCircle {
-  CupCircle(const QString &input, bool puzzle_2) {
+// The circle is stored as a successor array: m_next[label] is the label of
+// the cup clockwise of the cup with this label. Index 0 is unused.
+class CupCircle {
+public:
+  CupCircle(const QString &input, Label nb_cups = 0) {
     const QStringList lines = common::splitLines(input);
     if (lines.isEmpty())
-      return;
+      common::throwInvalidArgumentError("puzzle_2020_23::CupCircle: no input");
+    auto labels = std::vector<Label>();
     for (const QChar &c : lines.front()) {
-      m_cups << Cup(QString(c).toUInt());
-      m_value_max = std::max(m_cups.back().m_value, m_value_max);
-    }
-    if (puzzle_2) {
-      ++m_value_max;
-      for (; m_value_max <= 1e6; ++m_value_max)
-        m_cups << Cup(m_value_max);
-      --m_value_max;
+      if (not c.isDigit() or c == '0')
+        common::throwInvalidArgumentError(
+            QString("puzzle_2020_23::CupCircle: invalid cup label '%1'")
+                .arg(c));
+      labels.push_back(static_cast<Label>(c.digitValue()));
     }
-    if (m_cups.size() < 4)
-      return;
-    m_current = &m_cups.front();
-    m_current->m_previous = &m_cups.back();
-    m_cups.back().m_next = m_current;
-    m_cups_by_values.resize(m_value_max + 1);
-    m_cups_by_values[m_cups.front().m_value] = m_current;
-    for (auto it = std::next(m_cups.begin()); it != m_cups.end(); ++it) {
-      Cup *curr = &(*it);
-      Cup *prev = &(*std::prev(it));
-      prev->m_next = curr;
-      curr->m_previous = prev;
-      m_cups_by_values[curr->m_value] = curr;
+    for (auto label = static_cast<Label>(labels.size()) + 1; label <= nb_cups;
+         ++label)
+      labels.push_back(label);
+    if (labels.size() < 5)
+      common::throwInvalidArgumentError(
+          "puzzle_2020_23::CupCircle: not enough cups");
+    m_max_label = static_cast<Label>(labels.size());
+    m_next.assign(m_max_label + 1, 0);
+    for (auto i = std::size_t{0}; i < labels.size(); ++i) {
+      if (labels[i] > m_max_label or m_next[labels[i]] != 0)
+        common::throwInvalidArgumentError(
+            "puzzle_2020_23::CupCircle: cup labels must be a permutation");
+      m_next[labels[i]] = labels[(i + 1) % labels.size()];
     }
+    m_current = labels.front();
   }
 
-  Int previousValue(Int value) { return value == 1 ? m_value_max : value - 1; }
-
-  void pickup(Cup *start, Int pickup_size) {
-    if (pickup_size == 0)
-      return;
-    --pickup_size;
-    Cup *end = start;
-    for (Int i = 0; i < pickup_size; ++i)
-      end = end->m_next;
-    start->m_previous->m_next = end->m_next;
-    end->m_next->m_previous = start->m_previous;
-    start->m_previous = nullptr;
-    end->m_next = nullptr;
-  }
-
-  Cup *find(Int value) {
-    if (value < 1 || value >= static_cast<Int>(m_cups_by_values.size()))
-      return nullptr;
-    return m_cups_by_values[value];
-  }
-
-  void insert(Cup *source, Cup *destination) {
-    if (!source || !destination)
-      return;
-    Cup *dest_next = destination->m_next;
-    destination->m_next = source;
-    source->m_previous = destination;
-    Cup *curr = source;
-    while (curr->m_next && curr->m_next != source) {
-      curr = curr->m_next;
-    }
-    curr->m_next = dest_next;
-    dest_next->m_previous = curr;
-  }
-
-  bool contains(Cup *search, Cup *source) {
-    if (!search || !source)
-      return false;
-    Cup *curr = source;
-    do {
-      if (curr == search)
-        return true;
-      curr = curr->m_next;
-    } while (curr && curr != source);
-    return false;
-  }
-
-  bool move(Int nb_moves, Int pickup_size = 3, bool debug = false) {
+  void move(Int nb_moves) {
+    auto *next = m_next.data();
+    auto current = m_current;
     for (Int i = 0; i < nb_moves; ++i) {
-      if (debug) {
-        qDebug() << "-- move" << i + 1 << "--";
-        print("cups:", m_current);
-      }
-      Cup *pickup_start = m_current->m_next;
-      pickup(pickup_start, pickup_size);
-      if (debug)
-        print("pickup:", pickup_start);
-      Cup *destination = nullptr;
-      Int dest_value = m_current->m_value;
-      while (!destination) {
-        dest_value = previousValue(dest_value);
-        if (dest_value == m_current->m_value)
-          return false;
-        destination = find(dest_value);
-        if (contains(destination, pickup_start))
-          destination = nullptr;
-      }
-      if (debug) {
-        qDebug() << "destination:" << destination->m_value;
-        qDebug() << " ";
-      }
-      insert(pickup_start, destination);
-      m_current = m_current->m_next;
-    }
-    if (debug) {
-      qDebug() << "-- final --";
-      print("cups:", m_current);
+      const auto first = next[current];
+      const auto second = next[first];
+      const auto third = next[second];
+      auto destination = current;
+      do {
+        destination = destination == 1 ? m_max_label : destination - 1;
+      } while (destination == first or destination == second or
+               destination == third);
+      next[current] = next[third];
+      next[third] = next[destination];
+      next[destination] = first;
+      current = next[current];
     }
-    return true;
+    m_current = current;
   }
 
-  void print(QString header, Cup *curr) const {
-    qDebug() << header.toStdString().c_str()
-             << toString(curr ? curr : m_current).toStdString().c_str();
-  }
-
-  QString toString(Cup *curr) const {
-    if (!curr)
-      return "null";
+  QString labelsAfterOne() const {
     QString s;
-    Cup *first = curr;
-    do {
-      if (curr != first)
-        s += " ";
-      if (curr == m_current)
-        s += "(";
-      s += QString::number(curr->m_value);
-      if (curr == m_current)
-        s += ")";
-      curr = curr->m_next;
-    } while (curr && curr != first);
+    for (auto label = m_next[1]; label != 1; label = m_next[label])
+      s += QString::number(label);
     return s;
   }
 
-  QString state(bool puzzle_2) {
-    Cup *one = find(1);
-    if (!one)
-      return "No 1 cup";
-    if (puzzle_2) {
-      if (!one->m_next || !one->m_next->m_next)
-        return "No cups after 1";
-      return QString::number(one->m_next->m_value *
-                             one->m_next->m_next->m_value);
-    }
-    QString s;
-    Cup *curr = one->m_next;
-    while (curr && curr != one) {
-      s += QString::number(curr->m_value);
-      curr = curr->m_next;
-    }
-    return s;
+  Int starsProduct() const {
+    return static_cast<Int>(m_next[1]) * static_cast<Int>(m_next[m_next[1]]);
   }
 
-  Cup *m_current{nullptr};
-  QList<Cup> m_cups{};
-  QVector<Cup *> m_cups_by_values{};
-  Int m_value_max{0};
+private:
+  std::vector<Label> m_next{};
+  Label m_current{0};
+  Label m_max_label{0};
 };
 
 } // namespace puzzle_2020_23
 
 void Solver_2020_23_1::solve(const QString &input) {
   using namespace puzzle_2020_23;
-  CupCircle circle(input, false);
+  CupCircle circle(input);
   circle.move(100);
-  emit finished(circle.state(false));
+  emit finished(circle.labelsAfterOne());
 }
 
 void Solver_2020_23_2::solve(const QString &input) {
   using namespace puzzle_2020_23;
-  CupCircle circle(input, true);
-  circle.move(1e7);
-  emit finished(circle.state(true));
+  CupCircle circle(input, 1000000);
+  circle.move(10000000);
+  emit finished(QString::number(circle.starsProduct()));
 }
@@ -43,6 +43,7 @@ public slots:
 class Solver_2020_24_1 : public Solver {
 public:
   void solve(const QString &input) override;
+  bool requiresGuiThread() const override { return true; }
 };
 
 class Solver_2020_24_2 : public Solver {
@@ -1,21 +1,18 @@
-#include <deque>
-#include <initializer_list>
-#include <optional>
-#include <set>
+#include <algorithm>
+#include <array>
+#include <numeric>
 #include <solvers/2021/puzzle_2021_22.h>
 #include <solvers/common.h>
-
-#include <QDebug>
-#include <QFile>
-#include <QPen>
-#include <QTextStream>
+#include <utility>
+#include <vector>
 
 namespace puzzle_2021_22 {
 
 using Int = long long int;
-using UInt = unsigned long long int;
 
-struct Cuboid : public std::array<puzzle_2021_22::Int, 6> {
+// Bounds x0, x1, y0, y1, z0, z1 of the half-open box [x0, x1) x [y0, y1) x
+// [z0, z1)
+struct Cuboid : public std::array<Int, 6> {
   Cuboid() : std::array<Int, 6>{0, 0, 0, 0, 0, 0} {}
   Cuboid(std::array<Int, 6> &&arr) : std::array<Int, 6>(std::move(arr)) {}
 
@@ -36,14 +33,12 @@ struct Cuboid : public std::array<puzzle_2021_22::Int, 6> {
     return true;
   }
 
-  UInt volume() const {
-    auto vol = UInt{1};
+  Int volume() const {
+    auto vol = Int{1};
     for (auto i = 0; i < 3; ++i)
-      vol *= static_cast<Int>((*this)[2 * i + 1] - (*this)[2 * i]);
+      vol *= (*this)[2 * i + 1] - (*this)[2 * i];
     return vol;
   }
-
-  bool m_on{true};
 };
 
 struct RebootStep : Cuboid {
@@ -70,50 +65,194 @@ struct RebootStep : Cuboid {
     m_valid = true;
   }
 
+  bool m_on{true};
   bool m_valid;
 };
 
-struct Cuboids : public std::list<Cuboid> {
-  Cuboids() : std::list<Cuboid>{} {}
-
-  void add(const Cuboid &cuboid) {
-    for (auto it = begin(); it != end();) {
-      if (it->intersects(cuboid)) {
-        if (not cuboid.contains(*it)) {
-          auto coords = std::array<std::set<Int>, 3>{};
-          for (auto i = 0; i < 3; ++i) {
-            coords[i].insert((*it)[2 * i]);
-            coords[i].insert((*it)[2 * i + 1]);
-            coords[i].insert(cuboid[2 * i]);
-            coords[i].insert(cuboid[2 * i + 1]);
-          }
-          for (auto x = std::begin(coords[0]);
-               std::next(x) != std::end(coords[0]); ++x) {
-            for (auto y = std::begin(coords[1]);
-                 std::next(y) != std::end(coords[1]); ++y) {
-              for (auto z = std::begin(coords[2]);
-                   std::next(z) != std::end(coords[2]); ++z) {
-                auto new_cuboid = Cuboid{
-                    {*x, *std::next(x), *y, *std::next(y), *z, *std::next(z)}};
-                if (it->contains(new_cuboid) and
-                    not cuboid.contains(new_cuboid))
-                  it = std::next(insert(it, new_cuboid));
-              }
-            }
-          }
+/******************************************************************************/
+
+// Inclusion-exclusion over weighted cuboids: turning a cuboid on or off
+// first cancels its intersection with every stored cuboid by adding that
+// intersection with the opposite weight. Bounds are stored as structure of
+// arrays and grouped in blocks with a bounding box, so that whole blocks are
+// skipped and the remaining ones are tested lane by lane.
+class SignedCuboids {
+public:
+  void add(const Cuboid &cuboid, bool on) {
+    // Only the cuboids stored before this call are intersected
+    const auto size = std::size(m_weights);
+    const auto nb_blocks = (size + block_size - 1) / block_size;
+    auto hits = std::array<bool, block_size>();
+    for (auto block = std::size_t{0}; block < nb_blocks; ++block) {
+      if (not m_blocks[block].intersects(cuboid))
+        continue;
+      const auto begin = block * block_size;
+      const auto nb_lanes = std::min(block_size, size - begin);
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l) {
+        auto hit = true;
+        for (auto i = 0u; i < 3; ++i) {
+          hit &= m_bounds[2 * i][begin + l] < cuboid[2 * i + 1];
+          hit &= m_bounds[2 * i + 1][begin + l] > cuboid[2 * i];
+        }
+        hits[l] = hit;
+      }
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l) {
+        if (not hits[l])
+          continue;
+        auto intersection = Cuboid();
+        for (auto i = 0u; i < 3; ++i) {
+          intersection[2 * i] =
+              std::max(m_bounds[2 * i][begin + l], cuboid[2 * i]);
+          intersection[2 * i + 1] =
+              std::min(m_bounds[2 * i + 1][begin + l], cuboid[2 * i + 1]);
         }
-        it = erase(it);
-      } else
-        ++it;
+        push(intersection, -m_weights[begin + l]);
+      }
+    }
+    if (on)
+      push(cuboid, Int{1});
+    if (std::size(m_weights) > 2 * m_compacted_size + block_size)
+      compact();
+  }
+
+  Int volume() const {
+    auto vol = Int{0};
+    for (auto index = std::size_t{0}; index < std::size(m_weights); ++index)
+      vol += m_weights[index] * get(index).volume();
+    return vol;
+  }
+
+private:
+  static constexpr auto block_size = std::size_t{64};
+
+  Cuboid get(std::size_t index) const {
+    auto cuboid = Cuboid();
+    for (auto i = 0u; i < 6; ++i)
+      cuboid[i] = m_bounds[i][index];
+    return cuboid;
+  }
+
+  void push(const Cuboid &cuboid, Int weight) {
+    if (std::size(m_weights) % block_size == 0) {
+      m_blocks.push_back(cuboid);
+    } else {
+      auto &block = m_blocks.back();
+      for (auto i = 0u; i < 3; ++i) {
+        block[2 * i] = std::min(block[2 * i], cuboid[2 * i]);
+        block[2 * i + 1] = std::max(block[2 * i + 1], cuboid[2 * i + 1]);
+      }
     }
-    if (cuboid.m_on)
-      push_back(cuboid);
+    for (auto i = 0u; i < 6; ++i)
+      m_bounds[i].push_back(cuboid[i]);
+    m_weights.push_back(weight);
   }
+
+  // Merges the copies of the same cuboid and drops the ones whose weights
+  // cancel out. Sorting on x0 also keeps the blocks thin along x.
+  void compact() {
+    auto indices = std::vector<std::size_t>(std::size(m_weights));
+    std::iota(std::begin(indices), std::end(indices), std::size_t{0});
+    std::sort(std::begin(indices), std::end(indices),
+              [this](std::size_t lhs, std::size_t rhs) {
+                return get(lhs) < get(rhs);
+              });
+    auto cuboids = std::vector<Cuboid>();
+    auto weights = std::vector<Int>();
+    for (const auto index : indices) {
+      const auto cuboid = get(index);
+      if (not cuboids.empty() and cuboids.back() == cuboid) {
+        weights.back() += m_weights[index];
+      } else {
+        cuboids.push_back(cuboid);
+        weights.push_back(m_weights[index]);
+      }
+    }
+    for (auto &bounds : m_bounds)
+      bounds.clear();
+    m_weights.clear();
+    m_blocks.clear();
+    for (auto index = std::size_t{0}; index < std::size(cuboids); ++index)
+      if (weights[index] != 0)
+        push(cuboids[index], weights[index]);
+    m_compacted_size = std::size(m_weights);
+  }
+
+  std::array<std::vector<Int>, 6> m_bounds{};
+  std::vector<Int> m_weights{};
+  std::vector<Cuboid> m_blocks{};
+  std::size_t m_compacted_size{0};
 };
 
+// Reference implementation on the compressed grid: for every (x, y) cell,
+// the steps covering it are applied from last to first and each z cell is
+// counted by the last step that sets it, skipping the cells already set
+// through a union-find over z.
+Int compressedVolumeOn(const std::vector<const RebootStep *> &steps) {
+  auto coordinates = std::array<std::vector<Int>, 3>();
+  for (const auto *step : steps)
+    for (auto i = 0u; i < 6; ++i)
+      coordinates[i / 2].push_back((*step)[i]);
+  for (auto &axis : coordinates) {
+    std::sort(std::begin(axis), std::end(axis));
+    axis.erase(std::unique(std::begin(axis), std::end(axis)), std::end(axis));
+  }
+  auto ranges = std::vector<std::array<std::size_t, 6>>();
+  for (const auto *step : steps) {
+    auto &range = ranges.emplace_back();
+    for (auto i = 0u; i < 6; ++i) {
+      const auto &axis = coordinates[i / 2];
+      range[i] = static_cast<std::size_t>(
+          std::lower_bound(std::cbegin(axis), std::cend(axis), (*step)[i]) -
+          std::cbegin(axis));
+    }
+  }
+
+  const auto nb_z = std::size(coordinates[2]);
+  auto next = std::vector<std::size_t>(nb_z);
+  const auto find = [&next](std::size_t z) {
+    auto root = z;
+    while (next[root] != root)
+      root = next[root];
+    while (next[z] != root)
+      z = std::exchange(next[z], root);
+    return root;
+  };
+
+  auto vol = Int{0};
+  auto along_x = std::vector<std::size_t>();
+  for (auto x = std::size_t{0}; x + 1 < std::size(coordinates[0]); ++x) {
+    along_x.clear();
+    for (auto k = std::size_t{0}; k < std::size(steps); ++k)
+      if (ranges[k][0] <= x and x < ranges[k][1])
+        along_x.push_back(k);
+    const auto dx = coordinates[0][x + 1] - coordinates[0][x];
+    for (auto y = std::size_t{0}; y + 1 < std::size(coordinates[1]); ++y) {
+      std::iota(std::begin(next), std::end(next), std::size_t{0});
+      auto area = Int{0};
+      for (auto it = std::crbegin(along_x); it != std::crend(along_x); ++it) {
+        const auto &range = ranges[*it];
+        if (y < range[2] or y >= range[3])
+          continue;
+        for (auto z = find(range[4]); z < range[5]; z = find(z)) {
+          if (steps[*it]->m_on)
+            area += coordinates[2][z + 1] - coordinates[2][z];
+          next[z] = z + 1;
+        }
+      }
+      vol += dx * (coordinates[1][y + 1] - coordinates[1][y]) * area;
+    }
+  }
+  return vol;
+}
+
+/******************************************************************************/
+
+enum class Engine { SignedVolumes, CompressedGrid };
+
 class Reactor {
 public:
-  Reactor(const QString &input, bool initialization) {
+  Reactor(const QString &input, bool initialization,
+          Engine engine = Engine::SignedVolumes) {
     const auto lines = common::splitLines(input);
     m_reboot_steps.reserve(lines.size());
     for (const auto &line : lines) {
@@ -126,11 +265,18 @@ public:
       }
     }
     const auto init_cube = Cuboid({-50, 51, -50, 51, -50, 51});
-    for (auto &step : m_reboot_steps)
+    auto steps = std::vector<const RebootStep *>();
+    for (const auto &step : m_reboot_steps)
       if (not initialization or init_cube.contains(step))
-        m_cuboids.add(step);
-    for (const auto &c : m_cuboids)
-      m_volume_on += c.volume();
+        steps.push_back(&step);
+    if (engine == Engine::CompressedGrid) {
+      m_volume_on = compressedVolumeOn(steps);
+      return;
+    }
+    auto cuboids = SignedCuboids();
+    for (const auto *step : steps)
+      cuboids.add(*step, step->m_on);
+    m_volume_on = cuboids.volume();
   }
 
   const QString &invalidInput() const { return m_invalid_input; }
@@ -138,9 +284,8 @@ public:
 
 private:
   QString m_invalid_input{};
-  UInt m_volume_on{0};
+  Int m_volume_on{0};
   std::vector<RebootStep> m_reboot_steps{};
-  Cuboids m_cuboids;
 };
 
 } // namespace puzzle_2021_22
@@ -147,7 +147,7 @@ public:
   }
 
   QString lowestEnergy() const {
-    auto open_set = common::OpenSet<State, uint>{};
+    auto open_set = common::BucketOpenSet<State, uint>{};
     auto current = std::optional<std::pair<State, uint>>{};
     current = std::make_pair(m_root, 0u);
     while (current) {
@@ -44,7 +44,6 @@ struct Cell {
   void reset() {
     gCost = std::numeric_limits<uint>::max();
     previous = nullptr;
-    is_in_set = false;
   }
 
   uint elevation{0u};
@@ -52,35 +51,6 @@ struct Cell {
   uint hCost{0u};
   uint gCost{std::numeric_limits<uint>::max()};
   Cell *previous{nullptr};
-  bool is_in_set{false};
-};
-
-class OpenSet {
-public:
-  bool empty() const { return m_set.empty(); }
-
-  Cell *pop() {
-    auto it =
-        std::min_element(m_set.begin(), m_set.end(), [](auto lhs, auto rhs) {
-          return lhs->fCost() < rhs->fCost();
-        });
-    if (it == std::end(m_set))
-      return nullptr;
-    auto *cell = *it;
-    cell->is_in_set = false;
-    m_set.erase(it);
-    return cell;
-  }
-
-  void push(Cell *cell) {
-    if (not cell->is_in_set) {
-      cell->is_in_set = true;
-      m_set.push_back(cell);
-    }
-  }
-
-private:
-  std::list<Cell *> m_set{};
 };
 
 class ElevationMap {
@@ -131,10 +101,10 @@ public:
     auto *goal_cell = m_map[goal.i][goal.j];
     auto *cell = m_map[start.i][start.j];
     cell->gCost = 0u;
-    auto set = OpenSet{};
-    set.push(cell);
-    while (not set.empty()) {
-      cell = set.pop();
+    auto set = common::BucketOpenSet<Cell *, uint>{};
+    set.push(cell, cell->fCost());
+    while (const auto current = set.pop()) {
+      cell = current->first;
       if (cell == goal_cell) {
         auto path = Path{};
         do {
@@ -149,7 +119,7 @@ public:
         if (new_cost < neighbor->gCost) {
           neighbor->previous = cell;
           neighbor->gCost = new_cost;
-          set.push(neighbor);
+          set.push(neighbor, neighbor->fCost());
         }
       }
     }
@@ -1,7 +1,11 @@
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <optional>
 #include <set>
 #include <solvers/2022/puzzle_2022_15.h>
 #include <solvers/common.h>
+#include <solvers/threadpool.h>
+#include <vector>
 
 namespace puzzle_2022_15 {
 
@@ -42,99 +46,31 @@ private:
   Int m_range{0};
 };
 
-class Interval {
-public:
-  Interval(Int min, Int max)
-      : m_min{std::min(min, max)}, m_max{std::max(min, max)} {}
-
-  bool canMergeWith(const Interval &other) const {
-    if (m_max + 1 == other.min())
-      return true;
-    if (other.max() + 1 == m_min)
-      return true;
-    return m_min <= other.max() and other.min() <= m_max;
-  }
-
-  void mergeWith(const Interval &other) {
-    m_min = std::min(m_min, other.min());
-    m_max = std::max(m_max, other.max());
-  }
-
-  Int min() const { return m_min; }
-  Int max() const { return m_max; }
-  Int size() const { return m_max - m_min + 1; }
-  bool contains(Int value) const { return m_min <= value and value <= m_max; }
-
-private:
-  Int m_min;
-  Int m_max;
+// Inclusive range [min, max]
+struct Interval {
+  Int min{0};
+  Int max{0};
 };
 
-class Coverage {
-public:
-  Coverage() = default;
-
-  Coverage &operator<<(Interval interval) {
-    for (auto it = std::begin(m_intervals); it != std::end(m_intervals);) {
-      if (it->canMergeWith(interval)) {
-        interval.mergeWith(*it);
-        it = m_intervals.erase(it);
-      } else {
-        ++it;
-      }
-    }
-    for (auto it = std::begin(m_intervals); it != std::end(m_intervals); ++it) {
-      if (interval.max() < it->min()) {
-        m_intervals.insert(it, interval);
-        return *this;
-      }
-    }
-    m_intervals.push_back(interval);
-    return *this;
-  }
-
-  const std::list<Interval> &intervals() const { return m_intervals; }
-
-  Int size() const {
-    auto res = Int{0};
-    for (const auto &interval : m_intervals)
-      res += interval.size();
-    return res;
-  }
-
-  bool contains(Int value) const {
-    if (m_intervals.empty() or value < m_intervals.front().min() or
-        m_intervals.front().max() < value)
-      return false;
-    for (const auto &interval : m_intervals)
-      if (interval.contains(value))
-        return true;
-    return false;
-  }
-
-  Coverage getComplementIn(const Interval &interval) const {
-    auto complement = Coverage{};
-    if (m_intervals.empty()) {
-      complement << interval;
-      return complement;
-    }
-    if (interval.min() < m_intervals.front().min())
-      complement << Interval{interval.min(), m_intervals.front().min() - 1};
-    for (auto it = std::begin(m_intervals);
-         std::next(it) != std::end(m_intervals); ++it) {
-      if (interval.max() <= it->max())
-        return complement;
-      complement << Interval{
-          it->max() + 1, std::min(interval.max(), std::next(it)->min() - 1)};
-    }
-    if (interval.max() > m_intervals.back().max())
-      complement << Interval{m_intervals.back().max() + 1, interval.max()};
-    return complement;
+using Intervals = std::vector<Interval>;
+
+// Sorts the intervals and merges the overlapping or adjacent ones in place
+void merge(Intervals &intervals) {
+  std::sort(std::begin(intervals), std::end(intervals),
+            [](const Interval &lhs, const Interval &rhs) {
+              return lhs.min < rhs.min;
+            });
+  auto size = std::size_t{0};
+  for (const auto &interval : intervals) {
+    if (size > 0 and interval.min <= intervals[size - 1].max + 1)
+      intervals[size - 1].max = std::max(intervals[size - 1].max, interval.max);
+    else
+      intervals[size++] = interval;
   }
+  intervals.resize(size);
+}
 
-private:
-  std::list<Interval> m_intervals{};
-};
+enum class Engine { Geometric, RowScan };
 
 class Puzzle {
 public:
@@ -171,98 +107,123 @@ public:
   }
 
   QString solveOne(Int y) const {
-    const auto coverage = getXCoverageAt(y);
-    auto nb_locations = coverage.size();
+    auto coverage = Intervals();
+    getXCoverageAt(y, coverage);
+    auto nb_locations = Int{0};
+    for (const auto &interval : coverage)
+      nb_locations += interval.max - interval.min + 1;
     for (const auto &beacon : m_beacons)
-      if (beacon.y == y and coverage.contains(beacon.x))
+      if (beacon.y == y and isIn(coverage, beacon.x))
         --nb_locations;
     return QString("%1").arg(nb_locations);
   }
 
-  QString solveTwo(Int coord_max) const {
+  QString solveTwo(Int coord_max, Engine engine = Engine::Geometric) const {
     if (coord_max < 0)
       return "coord_max < 0";
-
-    const auto search_interval = Interval{0, coord_max};
-
-    auto x_possible_locations = std::unordered_map<Int, Coverage>{};
-    const auto get_x_possible_locations_at = [&x_possible_locations,
-                                              &search_interval,
-                                              this](Int y) -> const Coverage & {
-      auto it = x_possible_locations.find(y);
-      if (it == std::end(x_possible_locations))
-        it =
-            x_possible_locations
-                .insert({y, getXCoverageAt(y).getComplementIn(search_interval)})
-                .first;
-      return it->second;
-    };
-
-    auto y_possible_locations = std::unordered_map<Int, Coverage>{};
-    const auto get_y_possible_locations_at = [&y_possible_locations,
-                                              &search_interval,
-                                              this](Int x) -> const Coverage & {
-      auto it = y_possible_locations.find(x);
-      if (it == std::end(y_possible_locations))
-        it =
-            y_possible_locations
-                .insert({x, getYCoverageAt(x).getComplementIn(search_interval)})
-                .first;
-      return it->second;
-    };
-
-    for (auto x = search_interval.min(); x <= search_interval.max(); ++x) {
-      const auto &possible_y = get_y_possible_locations_at(x);
-      for (const auto &interval : possible_y.intervals()) {
-        for (auto y = interval.min(); y <= interval.max(); ++y) {
-          const auto &possible_x = get_x_possible_locations_at(y);
-          if (possible_x.contains(x))
-            return QString("%1").arg(Int{4000000} * x + y);
-        }
-      }
-    }
-
-    return "NO SOLUTION";
+    auto position = std::optional<Position>();
+    if (engine == Engine::Geometric)
+      position = findByBoundaries(coord_max);
+    if (not position)
+      position = findByRowScan(coord_max);
+    if (not position)
+      return "NO SOLUTION";
+    return QString("%1").arg(Int{4000000} * position->x + position->y);
   }
 
 private:
-  std::optional<Interval> getXCoverageAt(std::size_t i, Int y) const {
-    const auto delta_y = abs(y - m_sensors[i].position().y);
-    const auto delta_x = m_sensors[i].range() - delta_y;
-    if (delta_x < 0)
-      return std::nullopt;
-    return Interval{m_sensors[i].position().x - delta_x,
-                    m_sensors[i].position().x + delta_x};
+  static bool isIn(const Intervals &coverage, Int x) {
+    for (const auto &interval : coverage)
+      if (interval.min <= x and x <= interval.max)
+        return true;
+    return false;
   }
 
-  Coverage getXCoverageAt(Int y) const {
-    auto coverage = Coverage{};
-    for (auto i = 0u; i < m_sensors.size(); ++i) {
-      const auto &interval = getXCoverageAt(i, y);
-      if (interval.has_value())
-        coverage << *interval;
-    }
+  bool isCovered(const Position &position) const {
+    for (const auto &sensor : m_sensors)
+      if (sensor.position().distance(position) <= sensor.range())
+        return true;
+    return false;
+  }
 
-    return coverage;
+  // In rotated coordinates u = x + y and v = x - y, the cells just out of
+  // reach of a sensor lie on two u lines and two v lines. A single uncovered
+  // cell that is not on the border of the search area sits at the crossing
+  // of such a u line and such a v line.
+  std::optional<Position> findByBoundaries(Int coord_max) const {
+    auto us = std::vector<Int>();
+    auto vs = std::vector<Int>();
+    for (const auto &sensor : m_sensors) {
+      const auto &p = sensor.position();
+      const auto reach = sensor.range() + 1;
+      us.insert(std::end(us), {p.x + p.y - reach, p.x + p.y + reach});
+      vs.insert(std::end(vs), {p.x - p.y - reach, p.x - p.y + reach});
+    }
+    for (auto *lines : {&us, &vs}) {
+      std::sort(std::begin(*lines), std::end(*lines));
+      lines->erase(std::unique(std::begin(*lines), std::end(*lines)),
+                   std::end(*lines));
+    }
+    for (const auto u : us) {
+      for (const auto v : vs) {
+        if ((u - v) % 2 != 0)
+          continue;
+        const auto position = Position{(u + v) / 2, (u - v) / 2};
+        if (position.x < 0 or position.x > coord_max or position.y < 0 or
+            position.y > coord_max)
+          continue;
+        if (not isCovered(position))
+          return position;
+      }
+    }
+    return std::nullopt;
   }
 
-  std::optional<Interval> getYCoverageAt(std::size_t i, Int x) const {
-    const auto delta_x = abs(x - m_sensors[i].position().x);
-    const auto delta_y = m_sensors[i].range() - delta_x;
-    if (delta_y < 0)
-      return std::nullopt;
-    return Interval{m_sensors[i].position().y - delta_y,
-                    m_sensors[i].position().y + delta_y};
+  // Rows are interleaved across threads, each with its own interval buffer,
+  // and every thread stops as soon as one of them finds the cell
+  std::optional<Position> findByRowScan(Int coord_max) const {
+    const auto nb_threads = common::nbHardwareThreads();
+    auto found = std::atomic<bool>{false};
+    auto results = std::vector<std::optional<Position>>(nb_threads);
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          auto coverage = Intervals();
+          coverage.reserve(std::size(m_sensors));
+          for (auto y = static_cast<Int>(thread); y <= coord_max;
+               y += static_cast<Int>(nb_threads)) {
+            if (found)
+              return;
+            getXCoverageAt(y, coverage);
+            auto x = Int{0};
+            for (const auto &interval : coverage) {
+              if (interval.min > x)
+                break;
+              x = std::max(x, interval.max + 1);
+            }
+            if (x <= coord_max) {
+              results[thread] = Position{x, y};
+              found = true;
+              return;
+            }
+          }
+        },
+        nb_threads);
+    for (const auto &result : results)
+      if (result)
+        return result;
+    return std::nullopt;
   }
 
-  Coverage getYCoverageAt(Int x) const {
-    auto coverage = Coverage{};
-    for (auto i = 0u; i < m_sensors.size(); ++i) {
-      const auto &interval = getYCoverageAt(i, x);
-      if (interval.has_value())
-        coverage << *interval;
+  void getXCoverageAt(Int y, Intervals &coverage) const {
+    coverage.clear();
+    for (const auto &sensor : m_sensors) {
+      const auto delta_x = sensor.range() - std::abs(y - sensor.position().y);
+      if (delta_x >= 0)
+        coverage.push_back(Interval{sensor.position().x - delta_x,
+                                    sensor.position().x + delta_x});
     }
-    return coverage;
+    merge(coverage);
   }
 
   std::vector<Sensor> m_sensors;
@@ -1,9 +1,8 @@
-#include <memory>
+#include <algorithm>
 #include <set>
 #include <solvers/2022/puzzle_2022_16.h>
 #include <solvers/common.h>
-
-#include <iostream>
+#include <solvers/threadpool.h>
 
 namespace puzzle_2022_16 {
 
@@ -41,60 +40,65 @@ struct Valve {
   QStringList neighbors{};
 };
 
-using OtherAgent = std::optional<std::size_t>;
-
-struct State {
-  State(const Valve &valve, uint remaining_time)
-      : valve{valve.index}, remaining_time{remaining_time} {}
+// Useful valves are the ones with a positive flow rate, and a set of them is
+// a bit mask. Both opening orders of the same valves end up in the same
+// bestPerSet entry, which only keeps the best released pressure.
+class ValveSetSearch {
+public:
+  ValveSetSearch(const std::vector<uint> &flow_rates,
+                 const std::vector<uint> &distances)
+      : m_flow_rates{flow_rates}, m_distances{distances},
+        m_nb_valves{flow_rates.size()},
+        m_best_per_set(std::size_t{1} << m_nb_valves, 0u),
+        m_visits(m_nb_valves << m_nb_valves) {}
 
-  State(const std::vector<Valve> &valves, std::size_t valve,
-        uint transition_duration, std::shared_ptr<State> previous)
-      : valve{valve}, remaining_time{previous->remaining_time},
-        other_agent{previous->other_agent.has_value()
-                        ? OtherAgent{previous->valve}
-                        : OtherAgent{std::nullopt}},
-        previous{previous},
-        flow_rate{previous->flow_rate + valves[valve].flow_rate},
-        released_presure{previous->released_presure +
-                         transition_duration * previous->flow_rate},
-        closed_valves{previous->closed_valves} {
-    remaining_time -= transition_duration;
-    closed_valves.erase(valve);
-    auto heuristic_flow_rate = flow_rate;
-    for (auto index : closed_valves)
-      heuristic_flow_rate += valves[index].flow_rate;
-    cost = released_presure + remaining_time * heuristic_flow_rate;
+  // Opens first, then every reachable sequence of the other valves. The
+  // source is the last row of the distance matrix.
+  void run(std::size_t first, uint nb_minutes) {
+    const auto cost = m_distances[m_nb_valves * m_nb_valves + first] + 1u;
+    if (cost >= nb_minutes)
+      return;
+    const auto remaining_time = nb_minutes - cost;
+    explore(first, remaining_time, std::size_t{1} << first,
+            remaining_time * m_flow_rates[first]);
   }
 
-  std::size_t valve{std::numeric_limits<std::size_t>::max()};
-  uint remaining_time{0};
-  OtherAgent other_agent{std::nullopt};
-  uint transition_duration{0};
-  std::shared_ptr<State> previous{nullptr};
-  uint flow_rate{0};
-  uint released_presure{0};
-  std::set<std::size_t> closed_valves{};
-  uint cost{0};
-};
+  std::vector<uint> &bestPerSet() { return m_best_per_set; }
 
-bool operator<(const std::shared_ptr<State> &lhs,
-               const std::shared_ptr<State> &rhs) {
-  return lhs->cost > rhs->cost;
-}
-
-using Plan = std::list<std::shared_ptr<State>>;
+private:
+  struct Visit {
+    uint remaining_time{0};
+    uint pressure{0};
+  };
 
-struct OpenSet : public std::multiset<std::shared_ptr<State>> {
-  std::shared_ptr<State> pop() {
-    const auto it = this->begin();
-    if (it == this->end())
-      return nullptr;
-    const auto state = *it;
-    this->erase(it);
-    return state;
+  void explore(std::size_t valve, uint remaining_time, std::size_t opened,
+               uint pressure) {
+    auto &best = m_best_per_set[opened];
+    best = std::max(best, pressure);
+    for (auto next = std::size_t{0}; next < m_nb_valves; ++next) {
+      if ((opened >> next) & 1u)
+        continue;
+      const auto cost = m_distances[valve * m_nb_valves + next] + 1u;
+      if (cost >= remaining_time)
+        continue;
+      const auto next_time = remaining_time - cost;
+      const auto next_opened = opened | (std::size_t{1} << next);
+      const auto next_pressure = pressure + next_time * m_flow_rates[next];
+      // Standing at the same valve with the same opened set, but later and
+      // with less pressure, cannot lead to anything better
+      auto &visit = m_visits[next_opened * m_nb_valves + next];
+      if (visit.remaining_time >= next_time and visit.pressure >= next_pressure)
+        continue;
+      visit = Visit{next_time, next_pressure};
+      explore(next, next_time, next_opened, next_pressure);
+    }
   }
 
-  void push(std::shared_ptr<State> state) { this->insert(state); }
+  const std::vector<uint> &m_flow_rates;
+  const std::vector<uint> &m_distances;
+  std::size_t m_nb_valves;
+  std::vector<uint> m_best_per_set;
+  std::vector<Visit> m_visits;
 };
 
 class Volcano {
@@ -144,45 +148,80 @@ public:
 
   const std::vector<Valve> &valves() const { return m_valves; }
 
-  Plan computeOptimalPlan(const QString &source, uint nb_minutes,
-                          bool with_help = false) const {
-    auto current =
-        std::make_shared<State>(m_valves[m_label_to_index[source]], nb_minutes);
-    for (const auto &valve : m_valves)
-      if (valve.flow_rate > 0u)
-        current->closed_valves.insert(valve.index);
-    if (with_help)
-      current->other_agent = current->valve;
-    auto open_set = OpenSet{};
-    open_set.push(current);
-    while (not open_set.empty()) {
-      current = open_set.pop();
-      if (current->remaining_time == 0 or current->closed_valves.empty()) {
-        auto plan = Plan{};
-        do {
-          plan.push_front(current);
-          current = current->previous;
-        } while (current != nullptr);
-        return plan;
+  // Best released pressure for every set of opened useful valves
+  std::vector<uint> bestPressurePerValveSet(const QString &source,
+                                            uint nb_minutes) const {
+    auto useful_valves = std::vector<std::size_t>();
+    auto flow_rates = std::vector<uint>();
+    for (const auto &valve : m_valves) {
+      if (valve.flow_rate > 0u) {
+        useful_valves.push_back(valve.index);
+        flow_rates.push_back(valve.flow_rate);
       }
-      const auto previous_index = with_help and current->previous != nullptr
-                                      ? current->previous->valve
-                                      : current->valve;
-      auto remaining_time = current->remaining_time;
-      if (with_help)
-        remaining_time += current->transition_duration;
-      for (auto index : current->closed_valves) {
-
-        const auto transition_duration =
-            m_transitive_closure[current->valve][index];
-        if (transition_duration <= current->remaining_time) {
+    }
+    const auto nb_valves = useful_valves.size();
+    if (nb_valves > 16u) {
+      throw std::invalid_argument(
+          QString("puzzle_2022_16::Volcano: too many valves with a positive "
+                  "flow rate (%1)")
+              .arg(nb_valves)
+              .toStdString());
+    }
+    const auto source_it = m_label_to_index.constFind(source);
+    if (source_it == m_label_to_index.cend()) {
+      throw std::invalid_argument(
+          QString("puzzle_2022_16::Volcano: unknown valve \"%1\"")
+              .arg(source)
+              .toStdString());
+    }
+    useful_valves.push_back(source_it.value());
+    auto distances = std::vector<uint>();
+    distances.reserve(useful_valves.size() * nb_valves);
+    for (const auto from : useful_valves)
+      for (auto to = std::size_t{0}; to < nb_valves; ++to)
+        distances.push_back(m_transitive_closure[from][useful_valves[to]]);
 
-          open_set.push(std::make_shared<State>(
-              m_valves, index, transition_duration + 1u, current));
-        }
-      }
+    // Each thread explores the plans starting with its share of the valves
+    const auto nb_threads = std::max(
+        std::size_t{1}, std::min(common::nbHardwareThreads(), nb_valves));
+    auto searches = std::vector<std::optional<ValveSetSearch>>(nb_threads);
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          auto &search = searches[thread];
+          search.emplace(flow_rates, distances);
+          for (auto first = thread; first < nb_valves; first += nb_threads)
+            search->run(first, nb_minutes);
+        },
+        nb_threads);
+    auto best = std::move(searches.front()->bestPerSet());
+    for (auto i = std::size_t{1}; i < nb_threads; ++i) {
+      const auto &other = searches[i]->bestPerSet();
+      for (auto set = std::size_t{0}; set < best.size(); ++set)
+        best[set] = std::max(best[set], other[set]);
     }
-    return Plan{};
+    return best;
+  }
+
+  uint maxPressure(const QString &source, uint nb_minutes) const {
+    const auto best = bestPressurePerValveSet(source, nb_minutes);
+    return *std::max_element(std::cbegin(best), std::cend(best));
+  }
+
+  // The elephant and I open disjoint sets of valves. After a subset-maximum
+  // pass, best_subset[set] is the best pressure of any subset of set.
+  uint maxPressureWithHelp(const QString &source, uint nb_minutes) const {
+    const auto best = bestPressurePerValveSet(source, nb_minutes);
+    auto best_subset = best;
+    for (auto bit = std::size_t{1}; bit < best_subset.size(); bit <<= 1)
+      for (auto set = std::size_t{0}; set < best_subset.size(); ++set)
+        if (set & bit)
+          best_subset[set] = std::max(best_subset[set], best_subset[set ^ bit]);
+    const auto all = best.size() - 1u;
+    auto res = uint{0};
+    for (auto set = std::size_t{0}; set < best.size(); ++set)
+      res = std::max(res, best[set] + best_subset[all ^ set]);
+    return res;
   }
 
   QString toString() const {
@@ -211,35 +250,6 @@ public:
     return res;
   }
 
-  QString stateToString(const std::shared_ptr<State> &state) const {
-    auto res = QString("valve: %1, remaining time: %2, flow rate: %3, released "
-                       "presure: %4, cost: %5, closed valves: ")
-                   .arg(m_valves[state->valve].label)
-                   .arg(state->remaining_time)
-                   .arg(state->flow_rate)
-                   .arg(state->released_presure)
-                   .arg(state->cost);
-    for (auto index : state->closed_valves)
-      res += QString(" %1").arg(m_valves[index].label);
-    return res;
-  }
-
-  QString planToString(const Plan &plan) const {
-    auto res = QString("Plan: nb states = %1\n").arg(std::size(plan));
-    for (const auto &state : plan) {
-      res += stateToString(state);
-      res.push_back('\n');
-    }
-    return res;
-  }
-
-  QString openSetToString(const OpenSet &open_set) const {
-    auto res = QString("Open set:\n");
-    for (const auto &state : open_set)
-      res += "  " + stateToString(state) + "\n";
-    return res;
-  }
-
 private:
   std::vector<Valve> m_valves{};
   QMap<QString, std::size_t> m_label_to_index{};
@@ -251,13 +261,10 @@ private:
 
 void Solver_2022_16_1::solve(const QString &input) {
   const auto volcano = puzzle_2022_16::Volcano(input);
-  const auto plan = volcano.computeOptimalPlan("AA", 30);
-  //    emit output(volcano.planToString(plan));
-  //    emit output(volcano.toString());
-  emit finished(QString("%1").arg(plan.back()->cost));
+  emit finished(QString("%1").arg(volcano.maxPressure("AA", 30)));
 }
 
 void Solver_2022_16_2::solve(const QString &input) {
-  emit output(input);
-  emit finished("Default");
+  const auto volcano = puzzle_2022_16::Volcano(input);
+  emit finished(QString("%1").arg(volcano.maxPressureWithHelp("AA", 26)));
 }
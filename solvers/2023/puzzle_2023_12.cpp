@@ -1,149 +1,115 @@
+#include <algorithm>
 #include <solvers/2023/puzzle_2023_12.h>
 #include <solvers/common.h>
+#include <solvers/threadpool.h>
+#include <string>
 
 namespace puzzle_2023_12 {
 
 using Int = unsigned long long int;
 
-struct Key {
-  Key() = default;
-  Key(uint start, uint group_index) : start{start}, group_index{group_index} {}
-  uint start{0};
-  uint group_index{0};
+struct Record {
+  std::string springs{};
+  std::vector<uint> groups{};
 };
 
-bool operator<(const Key &lhs, const Key &rhs) {
-  if (lhs.start == rhs.start)
-    return lhs.group_index < rhs.group_index;
-  return lhs.start < rhs.start;
-}
-
-class Record {
-public:
-  Record(const QString &input, bool v2) {
-    const auto splitted = common::splitValues(input, ' ');
-    m_record = splitted[0];
-    m_groups = common::toVecUInt(splitted[1]);
-    if (v2) {
-      auto unfolded_record = QString{};
-      auto unfolded_groups = QVector<uint>{};
-      unfolded_groups.reserve(5 * m_groups.size());
-      for (auto i = 0; i < 5; ++i) {
-        unfolded_record += m_record;
-        if (i < 4)
-          unfolded_record.push_back('?');
-        for (auto group_size : m_groups)
-          unfolded_groups << group_size;
-      }
-      std::swap(m_record, unfolded_record);
-      std::swap(m_groups, unfolded_groups);
-    }
-    m_record_size = static_cast<uint>(m_record.size());
-    m_groups_size = static_cast<uint>(m_groups.size());
-  }
-
-  Int nbArrangements() { return nbArrangements(Key{0u, 0u}); }
-
-private:
-  uint leftToMatch(const Key &key) const {
-    auto left_to_match = 0u;
-    for (auto i = key.group_index + 1; i < m_groups_size; ++i)
-      left_to_match += m_groups[i];
-    return left_to_match;
-  }
-
-  bool isFree(uint index) const {
-    const auto &c = m_record.at(index);
-    return c == '.' or c == '?';
-  }
-
-  bool isPadded(uint index, uint group_size) const {
-    return (index == 0u or isFree(index - 1u)) and
-           (index + group_size >= m_record_size or isFree(index + group_size));
-  }
-
-  bool noneBroken(uint start, uint end) const {
-    for (auto i = start; i < end; ++i)
-      if (m_record.at(i) == '#')
-        return false;
-    return true;
-  }
-
-  uint nbBroken(uint start, uint end) const {
-    auto nb_broken = 0u;
-    for (auto i = start; i < end; ++i)
-      if (m_record.at(i) == '#')
-        ++nb_broken;
-    return nb_broken;
-  }
-
-  bool isAMatch(uint index, uint group_size) {
-    if (not isPadded(index, group_size))
-      return false;
-    for (auto i = 0u; i < group_size; ++i)
-      if (m_record.at(index + i) == '.')
-        return false;
-    return true;
-  }
+// Scratch space reused from one record to the next
+struct Buffers {
+  std::string springs{};
+  std::vector<uint> groups{};
+  std::vector<uint> damaged_runs{};
+  std::vector<Int> previous{};
+  std::vector<Int> current{};
+};
 
-  const QList<uint> &getMatches(const Key &key) {
-    auto insertion_result =
-        m_matches_map.insert(std::make_pair(key, QList<uint>{}));
-    if (insertion_result.second) {
-      const auto group_size = m_groups[key.group_index];
-      const auto left_to_match = leftToMatch(key);
-      for (auto i = key.start; i + group_size <= m_record_size; ++i) {
-        if (isAMatch(i, group_size)) {
-          if (noneBroken(key.start, i)) {
-            const auto next_start = i + group_size + 1u;
-            const auto nb_broken_after = nbBroken(next_start, m_record_size);
-            if (nb_broken_after <= left_to_match)
-              insertion_result.first->second << next_start;
-          }
-        }
-      }
-    }
-    return insertion_result.first->second;
+// Counts the arrangements group by group. After processing group j,
+// current[i] is the number of ways to place the first j groups in the first
+// i springs while accounting for every damaged spring among them.
+Int nbArrangements(const Record &record, uint unfold_factor,
+                   Buffers &buffers) {
+  auto &springs = buffers.springs;
+  auto &groups = buffers.groups;
+  springs.clear();
+  groups.clear();
+  for (auto i = 0u; i < unfold_factor; ++i) {
+    if (i > 0u)
+      springs.push_back('?');
+    springs.append(record.springs);
+    groups.insert(std::end(groups), std::cbegin(record.groups),
+                  std::cend(record.groups));
   }
-
-  Int nbArrangements(const Key &key) {
-    auto insertion_result =
-        m_arrangements_map.insert(std::make_pair(key, Int{0}));
-    if (insertion_result.second) {
-      const auto next_index = key.group_index + 1u;
-      if (next_index > m_groups_size) {
-        insertion_result.first->second = Int{1};
-      } else {
-        const auto &matches = getMatches(key);
-        for (auto start : matches)
-          insertion_result.first->second +=
-              nbArrangements(Key{start, next_index});
+  const auto size = springs.size();
+
+  // Number of consecutive springs that may be damaged ending at i - 1
+  auto &damaged_runs = buffers.damaged_runs;
+  damaged_runs.assign(size + 1u, 0u);
+  for (auto i = std::size_t{0}; i < size; ++i)
+    damaged_runs[i + 1u] = springs[i] == '.' ? 0u : damaged_runs[i] + 1u;
+
+  auto &previous = buffers.previous;
+  auto &current = buffers.current;
+  current.assign(size + 1u, Int{0});
+  current[0] = Int{1};
+  for (auto i = std::size_t{0}; i < size and springs[i] != '#'; ++i)
+    current[i + 1u] = Int{1};
+
+  for (const auto group : groups) {
+    std::swap(previous, current);
+    current.assign(size + 1u, Int{0});
+    for (auto i = std::size_t{1}; i <= size; ++i) {
+      if (springs[i - 1u] != '#')
+        current[i] = current[i - 1u];
+      if (damaged_runs[i] >= group) {
+        const auto first = i - group;
+        if (first == 0u)
+          current[i] += previous[0];
+        else if (springs[first - 1u] != '#')
+          current[i] += previous[first - 1u];
       }
     }
-    return insertion_result.first->second;
   }
-
-  QString m_record;
-  QVector<uint> m_groups;
-  uint m_record_size;
-  uint m_groups_size;
-  std::map<Key, QList<uint>> m_matches_map;
-  std::map<Key, Int> m_arrangements_map;
-};
+  return current[size];
+}
 
 class Records {
 public:
-  Records(const QString &input, bool v2) {
-    auto lines = common::splitLines(input);
+  Records(const QString &input) {
+    const auto lines = common::splitLines(input, true);
     m_records.reserve(lines.size());
-    for (const auto &line : lines)
-      m_records.emplace_back(line, v2);
+    for (const auto &line : lines) {
+      const auto splitted = common::splitValues(line, ' ');
+      if (splitted.size() != 2)
+        common::throwInvalidArgumentError(
+            QString("Records: invalid record \"%1\"").arg(line));
+      auto &record = m_records.emplace_back();
+      record.springs = splitted[0].toStdString();
+      for (const auto c : record.springs)
+        if (c != '.' and c != '#' and c != '?')
+          common::throwInvalidArgumentError(
+              QString("Records: invalid spring '%1'").arg(c));
+      for (const auto group : common::toVecUInt(splitted[1]))
+        record.groups.push_back(group);
+    }
   }
 
-  QString solve() {
+  // Records are independent, so each thread counts its share of them
+  QString solve(uint unfold_factor) const {
+    const auto nb_threads = std::max(
+        std::size_t{1},
+        std::min(common::nbHardwareThreads(), m_records.size() / 16u));
+    auto sums = std::vector<Int>(nb_threads, Int{0});
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          auto buffers = Buffers();
+          for (auto i = thread; i < m_records.size(); i += nb_threads)
+            sums[thread] +=
+                nbArrangements(m_records[i], unfold_factor, buffers);
+        },
+        nb_threads);
     auto sum = Int{0};
-    for (auto &record : m_records)
-      sum += record.nbArrangements();
+    for (const auto value : sums)
+      sum += value;
     return QString("%1").arg(sum);
   }
 
@@ -154,11 +120,11 @@ private:
 } // namespace puzzle_2023_12
 
 void Solver_2023_12_1::solve(const QString &input) {
-  auto records = puzzle_2023_12::Records{input, false};
-  emit finished(records.solve());
+  const auto records = puzzle_2023_12::Records{input};
+  emit finished(records.solve(1u));
 }
 
 void Solver_2023_12_2::solve(const QString &input) {
-  auto records = puzzle_2023_12::Records{input, true};
-  emit finished(records.solve());
+  const auto records = puzzle_2023_12::Records{input};
+  emit finished(records.solve(5u));
 }
@@ -1,193 +1,226 @@
-#include <QBitArray>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <solvers/2023/puzzle_2023_14.h>
 #include <solvers/common.h>
+#include <unordered_map>
+#include <vector>
 
 namespace puzzle_2023_14 {
 
-enum class Cell { Rounded, Cube, Empty };
+using Word = std::uint64_t;
 
-enum class Direction { North, West, South, East };
+constexpr auto word_size = 64u;
+constexpr auto nb_words = 2u;
+constexpr auto max_size = word_size * nb_words;
 
-enum class Orientation { Vertical, Horizontal };
+// Line of the platform as a bit mask, bit i being the cell at index i
+using Line = std::array<Word, nb_words>;
+using Lines = std::array<Line, max_size>;
 
-inline Orientation getOrientation(Direction direction) {
-  if (direction == Direction::North or direction == Direction::South)
-    return Orientation::Vertical;
-  if (direction == Direction::West or direction == Direction::East)
-    return Orientation::Horizontal;
-  common::throwInvalidArgumentError("unknown direction");
-  return Orientation::Vertical;
+inline uint popCount(Word word) {
+  return static_cast<uint>(std::bitset<word_size>(word).count());
 }
 
-struct IndexAndLoad {
-  IndexAndLoad() = default;
-  IndexAndLoad(uint index, uint load) : index{index}, load{load} {}
-  uint index{0};
-  uint load{0};
-};
+// Bits of [begin, end) that fall into the given word
+inline Word rangeMask(uint begin, uint end, uint word) {
+  const auto low = std::max(begin, word * word_size);
+  const auto high = std::min(end, (word + 1) * word_size);
+  if (low >= high)
+    return Word{0};
+  const auto size = high - low;
+  const auto bits = size == word_size ? ~Word{0} : (Word{1} << size) - 1;
+  return bits << (low - word * word_size);
+}
 
-class ControlPanel {
-public:
-  ControlPanel(const QString &input) {
-    auto lines = common::splitLines(input);
-    m_lenght = lines.size();
-    m_cells.reserve(m_lenght);
-    if (m_lenght == 0)
-      common::throwInvalidArgumentError("empty pannel");
-    m_width = lines.front().size();
-    for (const auto &line : lines) {
-      if (line.size() != m_width)
-        common::throwInvalidArgumentError("incoherent width");
-      m_cells.emplace_back();
-      m_cells.back().reserve(m_width);
-      for (const auto &c : line) {
-        if (c == 'O')
-          m_cells.back().emplace_back(Cell::Rounded);
-        else if (c == '#')
-          m_cells.back().emplace_back(Cell::Cube);
-        else if (c == '.')
-          m_cells.back().emplace_back(Cell::Empty);
-        else
-          common::throwInvalidArgumentError("unknown cell type");
-      }
+// In-place transposition of a 64 x 64 bit block, bit j of word i being
+// swapped with bit i of word j
+void transpose(std::array<Word, word_size> &block) {
+  auto mask = Word{0x00000000ffffffff};
+  for (auto shift = word_size / 2; shift != 0;
+       shift >>= 1, mask ^= mask << shift) {
+    for (auto k = 0u; k < word_size; k = ((k | shift) + 1) & ~shift) {
+      const auto swapped = ((block[k] >> shift) ^ block[k | shift]) & mask;
+      block[k] ^= swapped << shift;
+      block[k | shift] ^= swapped;
     }
   }
+}
 
-  QBitArray toBitArray() const {
-    auto array = QBitArray(m_lenght * m_width);
-    auto bit_index = 0;
-    for (auto i = 0; i < m_lenght; ++i) {
-      for (auto j = 0; j < m_width; ++j) {
-        array.setBit(bit_index++, m_cells[i][j] == Cell::Rounded);
-      }
+void transpose(Lines &lines) {
+  auto blocks = std::array<std::array<Word, word_size>, nb_words * nb_words>();
+  for (auto i = 0u; i < nb_words; ++i) {
+    for (auto j = 0u; j < nb_words; ++j) {
+      auto &block = blocks[nb_words * i + j];
+      for (auto k = 0u; k < word_size; ++k)
+        block[k] = lines[i * word_size + k][j];
+      transpose(block);
     }
-    return array;
   }
+  for (auto i = 0u; i < nb_words; ++i)
+    for (auto j = 0u; j < nb_words; ++j)
+      for (auto k = 0u; k < word_size; ++k)
+        lines[j * word_size + k][i] = blocks[nb_words * i + j][k];
+}
 
-  bool isFree(int i, int j) {
-    return i >= 0 and i < m_lenght and j >= 0 and j < m_width and
-           m_cells[i][j] == Cell::Empty;
-  }
+// Maximal run of cells without cube rocks in a line
+struct Segment {
+  uint line{0};
+  uint start{0};
+  uint size{0};
+  Line mask{};
+};
 
-  int getShift(Direction direction, int i, int j) {
-    auto shift = 0;
-    if (direction == Direction::North)
-      for (; isFree(i + shift - 1, j); --shift) {
-      }
-    else if (direction == Direction::West)
-      for (; isFree(j, i + shift - 1); --shift) {
-      }
-    else if (direction == Direction::South)
-      for (; isFree(i + shift + 1, j); ++shift) {
+std::vector<Segment> getSegments(const Lines &cubes, uint nb_lines,
+                                 uint line_size) {
+  auto segments = std::vector<Segment>();
+  for (auto i = 0u; i < nb_lines; ++i) {
+    auto start = 0u;
+    for (auto j = 0u; j <= line_size; ++j) {
+      if (j < line_size and
+          (cubes[i][j / word_size] >> (j % word_size) & 1u) == 0)
+        continue;
+      if (start < j) {
+        auto &segment = segments.emplace_back();
+        segment.line = i;
+        segment.start = start;
+        segment.size = j - start;
+        for (auto w = 0u; w < nb_words; ++w)
+          segment.mask[w] = rangeMask(start, j, w);
       }
-    else if (direction == Direction::East)
-      for (; isFree(j, i + shift + 1); ++shift) {
-      }
-    return shift;
+      start = j + 1;
+    }
   }
+  return segments;
+}
 
-  void tiltLine(Direction direction, int j) {
-    const auto orientation = getOrientation(direction);
-    const auto max =
-        (orientation == Orientation::Horizontal ? m_width : m_lenght);
-    const auto max_othogonal =
-        (orientation == Orientation::Horizontal ? m_lenght : m_width);
-    if (j >= 0 and j < max_othogonal) {
-      const auto start =
-          (direction == Direction::North or direction == Direction::West)
-              ? 1
-              : max - 2;
-      const auto go_on = [direction, max](int i) {
-        if (direction == Direction::North or direction == Direction::West)
-          return i < max;
-        return i >= 0;
-      };
-      const auto increment = [direction, max](int &i) {
-        if (direction == Direction::North or direction == Direction::West)
-          ++i;
-        else
-          --i;
-      };
-      for (auto i = start; go_on(i); increment(i)) {
-        const auto cell = orientation == Orientation::Horizontal
-                              ? m_cells[j][i]
-                              : m_cells[i][j];
-        if (cell == Cell::Rounded) {
-          const auto shift = getShift(direction, i, j);
-          if (shift != 0) {
-            if (orientation == Orientation::Horizontal) {
-              m_cells[j][i + shift] = Cell::Rounded;
-              m_cells[j][i] = Cell::Empty;
-            } else {
-              m_cells[i + shift][j] = Cell::Rounded;
-              m_cells[i][j] = Cell::Empty;
-            }
-          }
-        }
-      }
-    }
+// Packs the round rocks of every segment at its start or at its end
+void roll(Lines &rounds, const std::vector<Segment> &segments,
+          bool towards_start) {
+  for (const auto &segment : segments) {
+    auto &line = rounds[segment.line];
+    auto nb_rounds = 0u;
+    for (auto w = 0u; w < nb_words; ++w)
+      nb_rounds += popCount(line[w] & segment.mask[w]);
+    if (nb_rounds == 0u or nb_rounds == segment.size)
+      continue;
+    const auto begin = towards_start
+                           ? segment.start
+                           : segment.start + segment.size - nb_rounds;
+    for (auto w = 0u; w < nb_words; ++w)
+      line[w] =
+          (line[w] & ~segment.mask[w]) | rangeMask(begin, begin + nb_rounds, w);
   }
+}
+
+inline Word hash(const Lines &lines) {
+  auto hash = Word{0xcbf29ce484222325};
+  for (const auto &line : lines)
+    for (const auto word : line)
+      hash = (hash ^ word) * Word{0x100000001b3} + (hash >> 29);
+  return hash;
+}
 
-  void tilt(Direction direction) {
-    const auto orientation = getOrientation(direction);
-    const auto max =
-        (orientation == Orientation::Horizontal ? m_width : m_lenght);
-    for (auto index = 0; index < max; ++index)
-      tiltLine(direction, index);
+class ControlPanel {
+public:
+  ControlPanel(const QString &input) {
+    const auto lines = common::splitLines(input, true);
+    if (lines.isEmpty())
+      common::throwInvalidArgumentError("ControlPanel: empty panel");
+    m_length = static_cast<uint>(lines.size());
+    m_width = static_cast<uint>(lines.front().size());
+    if (m_length > max_size or m_width > max_size)
+      common::throwInvalidArgumentError(
+          QString("ControlPanel: panels are at most %1 wide").arg(max_size));
+
+    auto cubes = Lines();
+    for (auto i = 0u; i < m_length; ++i) {
+      const auto &line = lines[static_cast<int>(i)];
+      if (static_cast<uint>(line.size()) != m_width)
+        common::throwInvalidArgumentError("ControlPanel: incoherent width");
+      for (auto j = 0u; j < m_width; ++j) {
+        const auto c = line[static_cast<int>(j)];
+        const auto bit = Word{1} << (j % word_size);
+        if (c == 'O')
+          m_rounds[i][j / word_size] |= bit;
+        else if (c == '#')
+          cubes[i][j / word_size] |= bit;
+        else if (c != '.')
+          common::throwInvalidArgumentError(
+              QString("ControlPanel: unknown cell type '%1'").arg(c));
+      }
+    }
+    m_row_segments = getSegments(cubes, m_length, m_width);
+    transpose(cubes);
+    m_column_segments = getSegments(cubes, m_width, m_length);
   }
 
   uint getLoad() const {
     auto load = 0u;
-    for (auto i = 0; i < m_lenght; ++i) {
-      for (auto j = 0; j < m_width; ++j) {
-        if (m_cells[i][j] == Cell::Rounded) {
-          load += static_cast<uint>(m_width - i);
-        }
-      }
-    }
+    for (auto i = 0u; i < m_length; ++i)
+      for (const auto word : m_rounds[i])
+        load += popCount(word) * (m_length - i);
     return load;
   }
 
+  void tiltNorth() {
+    transpose(m_rounds);
+    roll(m_rounds, m_column_segments, true);
+    transpose(m_rounds);
+  }
+
+  // North, west, south and east. Columns are rolled on the transposed
+  // platform, so that every tilt works on whole lines.
   void tiltCycle() {
-    tilt(Direction::North);
-    tilt(Direction::West);
-    tilt(Direction::South);
-    tilt(Direction::East);
+    transpose(m_rounds);
+    roll(m_rounds, m_column_segments, true);
+    transpose(m_rounds);
+    roll(m_rounds, m_row_segments, true);
+    transpose(m_rounds);
+    roll(m_rounds, m_column_segments, false);
+    transpose(m_rounds);
+    roll(m_rounds, m_row_segments, false);
   }
 
   QString solveOne() {
-    tilt(Direction::North);
+    tiltNorth();
     return QString("%1").arg(getLoad());
   }
 
+  // States are looked up by hash and compared in full only on a hash match
   QString solveTwo() {
-    const auto nb_cycles = 1000000000u;
-    auto index_to_array = std::vector<QBitArray>{};
-    index_to_array.reserve(nb_cycles);
-    auto array_to_index_and_load = QHash<QBitArray, IndexAndLoad>{};
-    auto loop_start = 0u;
-    for (auto index = 0u;; ++index) {
+    const auto nb_cycles = std::size_t{1000000000};
+    auto states = std::vector<Lines>{m_rounds};
+    auto loads = std::vector<uint>{getLoad()};
+    auto indices = std::unordered_multimap<Word, std::size_t>{};
+    indices.emplace(hash(m_rounds), 0);
+    while (true) {
       tiltCycle();
-      const auto array = toBitArray();
-      if (array_to_index_and_load.contains(array)) {
-        loop_start = array_to_index_and_load[array].index;
-        break;
+      const auto key = hash(m_rounds);
+      const auto range = indices.equal_range(key);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (states[it->second] == m_rounds) {
+          const auto loop_start = it->second;
+          const auto loop_size = std::size(states) - loop_start;
+          const auto index = loop_start + (nb_cycles - loop_start) % loop_size;
+          return QString("%1").arg(loads[index]);
+        }
       }
-      array_to_index_and_load[array] = IndexAndLoad{index, getLoad()};
-      index_to_array.emplace_back(array);
+      indices.emplace(key, std::size(states));
+      states.push_back(m_rounds);
+      loads.push_back(getLoad());
+      if (std::size(states) > nb_cycles)
+        return QString("%1").arg(loads.back());
     }
-    const auto loop_end = index_to_array.size();
-    const auto loop_size = loop_end - loop_start;
-    const auto nb_cycles_mod = (nb_cycles - loop_start) % loop_size;
-    const auto index = nb_cycles_mod + loop_start - 1u;
-    const auto load = array_to_index_and_load[index_to_array[index]].load;
-    return QString("%1").arg(load);
   }
 
 private:
-  std::vector<std::vector<Cell>> m_cells;
-  int m_lenght{0};
-  int m_width{0};
+  Lines m_rounds{};
+  std::vector<Segment> m_row_segments{};
+  std::vector<Segment> m_column_segments{};
+  uint m_length{0};
+  uint m_width{0};
 };
 
 } // namespace puzzle_2023_14
@@ -1,6 +1,38 @@
 #pragma once
 #include <solvers/solvers.h>
 
+namespace puzzle_2023_21 {
+
+using Int = unsigned long long int;
+
+// Plots reachable from the start of a garden tiled infinitely. A single BFS
+// runs over nb_tiles x nb_tiles copies of the map around the start, and
+// larger step numbers are extrapolated from the quadratic growth of the
+// number of reachable plots every map dimension steps.
+class Garden {
+public:
+  Garden(const QString &input, int nb_tiles = 7);
+
+  int dimension() const;
+
+  // Largest step number for which no reachable plot lies outside the tiles
+  Int maxExactSteps() const;
+
+  Int nbReachablePlots(Int nb_steps) const;
+
+private:
+  Int extrapolate(Int nb_steps) const;
+
+  std::vector<bool> m_rocks{};
+  int m_dimension{0};
+  int m_start_row{0};
+  int m_start_column{0};
+  bool m_is_walled_in{false};
+  std::vector<Int> m_nb_reachable{};
+};
+
+} // namespace puzzle_2023_21
+
 class Solver_2023_21_1 : public Solver {
 public:
   void solve(const QString &input) override;
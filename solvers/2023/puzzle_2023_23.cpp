@@ -1,9 +1,9 @@
-#include <QQueue>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <solvers/2023/puzzle_2023_23.h>
 #include <solvers/common.h>
-
-#include <QFile>
-#include <QTextStream>
+#include <solvers/threadpool.h>
 
 namespace puzzle_2023_23 {
 
@@ -30,30 +30,6 @@ inline QVector<Direction> getNextDirections(const QChar &c, bool is_icy) {
   return directions;
 }
 
-inline Direction oppositeDirection(const Direction direction) {
-  if (direction == Direction::north)
-    return Direction::south;
-  if (direction == Direction::west)
-    return Direction::east;
-  if (direction == Direction::south)
-    return Direction::north;
-  if (direction == Direction::east)
-    return Direction::west;
-  return Direction::none;
-}
-
-inline QString dirToString(const Direction direction) {
-  if (direction == Direction::north)
-    return "^";
-  if (direction == Direction::west)
-    return "<";
-  if (direction == Direction::south)
-    return "v";
-  if (direction == Direction::east)
-    return ">";
-  return "?";
-}
-
 struct Vertex {
   Vertex() = default;
   Vertex(int x, int y) : x{x}, y{y} {}
@@ -72,8 +48,6 @@ struct Vertex {
           "Vertex::constructor: unknown direction");
   }
 
-  QString toString() const { return QString("%1,%2").arg(x).arg(y); }
-
   int x{0};
   int y{0};
 };
@@ -82,8 +56,6 @@ bool operator==(const Vertex &lhs, const Vertex &rhs) {
   return lhs.x == rhs.x and lhs.y == rhs.y;
 }
 
-uint qHash(const Vertex &vertex) { return qHash(vertex.toString()); }
-
 class Grid {
 public:
   Grid(const QString &input) : m_start{-1, -1}, m_end{-1, -1} {
@@ -141,191 +113,184 @@ private:
   int m_width;
 };
 
-struct Neighbors {
-  QSet<Vertex> parents{};
-  QSet<Vertex> children{};
+// Junctions are the start, the end and the cells with more than two free
+// neighbors. Corridors between them become weighted edges.
+struct Junction {
+  std::array<std::uint8_t, 4> neighbors{};
+  std::array<uint, 4> lengths{};
+  std::uint8_t nb_neighbors{0};
+  // Longest edge entering the junction, for the upper bound of the search
+  uint max_entering_length{0};
 };
 
-struct Edge {
-  Edge() = default;
-  Edge(const Vertex &head, const Vertex &tail) : head{head}, tail{tail} {}
-
-  QString toString() const { return head.toString() + "|" + tail.toString(); }
-
-  Vertex head{};
-  Vertex tail{};
-};
-
-bool operator==(const Edge &lhs, const Edge &rhs) {
-  return lhs.head == rhs.head and lhs.tail == rhs.tail;
-}
-
-uint qHash(const Edge &edge) { return qHash(edge.toString()); }
-
 struct Path {
-  Path() = default;
-  Path(const Vertex &vertex) : last{vertex}, vertices{vertex} {}
-  Path(const Path &parent, const Vertex &child, const uint edge_length)
-      : last{child}, vertices{parent.vertices},
-        length{parent.length + edge_length} {
-    vertices << child;
-  }
-
-  Vertex last{};
-  QSet<Vertex> vertices{};
+  std::uint8_t last{0};
+  std::uint64_t visited{0};
   uint length{0};
+  // Upper bound of the length the path may still gain
+  uint remaining{0};
 };
 
 class Graph {
 public:
   Graph(const QString &input, bool is_icy) : m_grid{input} {
-    // Add all nodes
+    auto ids = std::vector<std::vector<int>>(
+        m_grid.length(), std::vector<int>(m_grid.width(), -1));
+    const auto add_junction = [this, &ids](const Vertex &vertex) {
+      if (m_junctions.size() == 64u)
+        common::throwRunTimeError(
+            "Graph::constructor: more than 64 junctions");
+      ids[vertex.x][vertex.y] = static_cast<int>(m_junctions.size());
+      m_positions.push_back(vertex);
+      m_junctions.emplace_back();
+    };
+    add_junction(m_grid.start());
+    add_junction(m_grid.end());
     for (auto i = 0; i < m_grid.length(); ++i) {
       for (auto j = 0; j < m_grid.width(); ++j) {
-        const auto head = Vertex{i, j};
-        if (m_grid.isFree(head)) {
-          for (const auto direction :
-               getNextDirections(m_grid.cells()[i][j], is_icy)) {
-            const auto tail = Vertex{head, direction};
-            if (m_grid.isFree(tail)) {
-              m_vertices[head].children << tail;
-              m_vertices[tail].parents << head;
-              m_edges[Edge{head, tail}] = 1u;
+        const auto vertex = Vertex{i, j};
+        if (not m_grid.isFree(vertex) or ids[i][j] != -1)
+          continue;
+        auto nb_free_neighbors = 0;
+        for (const auto direction : directions)
+          if (m_grid.isFree(Vertex{vertex, direction}))
+            ++nb_free_neighbors;
+        if (nb_free_neighbors > 2)
+          add_junction(vertex);
+      }
+    }
+
+    // Follows every corridor, which may only be walked along one way when
+    // it contains slopes
+    const auto can_move = [this, is_icy](const Vertex &vertex,
+                                         const Direction direction) {
+      return getNextDirections(m_grid.cells()[vertex.x][vertex.y], is_icy)
+          .contains(direction);
+    };
+    for (auto id = 0u; id < m_junctions.size(); ++id) {
+      for (const auto first_direction : directions) {
+        auto previous = m_positions[id];
+        auto current = Vertex{previous, first_direction};
+        if (not m_grid.isFree(current))
+          continue;
+        auto is_walkable = can_move(previous, first_direction);
+        auto length = 1u;
+        while (ids[current.x][current.y] == -1) {
+          auto next_direction = Direction::none;
+          for (const auto direction : directions) {
+            const auto next = Vertex{current, direction};
+            if (m_grid.isFree(next) and not(next == previous)) {
+              next_direction = direction;
+              break;
             }
           }
+          if (next_direction == Direction::none)
+            break;
+          is_walkable = is_walkable and can_move(current, next_direction);
+          previous = current;
+          current = Vertex{current, next_direction};
+          ++length;
         }
+        const auto tail = ids[current.x][current.y];
+        if (is_walkable and tail != -1)
+          addEdge(id, static_cast<uint>(tail), length);
       }
     }
+  }
 
-    exportToCSV(
-        "/home/aboeuf/Projects/AdventOfCode/python/2023/day_23/before.txt");
-
-    const auto get_prunning_neighbors =
-        [this](
-            const QHash<Vertex, Neighbors>::iterator &vertex) -> QSet<Vertex> {
-      if (vertex->parents.size() != 2 or vertex->children.size() != 2)
-        return QSet<Vertex>{};
-      auto neighbors = QSet<Vertex>{};
-      for (auto &parent : vertex->parents)
-        neighbors << parent;
-      for (auto &child : vertex->children)
-        neighbors << child;
-      if (neighbors.size() != 2)
-        return QSet<Vertex>{};
-      return neighbors;
-    };
-
-    // Prune nodes with only one parent and one child
-    auto vertex = std::begin(m_vertices);
-    for (; vertex != std::end(m_vertices);) {
-      const auto neighbors = get_prunning_neighbors(vertex);
-      if (neighbors.size() == 2) {
-        auto it = std::begin(vertex->parents);
-        auto A = m_vertices.find(*it);
-        if (A == std::end(m_vertices))
-          common::throwRunTimeError("Graph::constructor: cannot find vertex A");
-
-        ++it;
-        auto B = m_vertices.find(*it);
-        if (B == std::end(m_vertices))
-          common::throwRunTimeError("Graph::constructor: cannot find vertex B");
-
-        const auto A_to_vertex = m_edges.find(Edge{A.key(), vertex.key()});
-        if (A_to_vertex == std::end(m_edges))
-          common::throwRunTimeError(
-              "Graph::constructor: cannot find edge A to vertex");
-
-        const auto vertex_to_A = m_edges.find(Edge{vertex.key(), A.key()});
-        if (vertex_to_A == std::end(m_edges))
-          common::throwRunTimeError(
-              "Graph::constructor: cannot find edge vertex to A");
-
-        const auto B_to_vertex = m_edges.find(Edge{B.key(), vertex.key()});
-        if (B_to_vertex == std::end(m_edges))
-          common::throwRunTimeError(
-              "Graph::constructor: cannot find edge B to vertex");
-
-        const auto vertex_to_B = m_edges.find(Edge{vertex.key(), B.key()});
-        if (vertex_to_B == std::end(m_edges))
-          common::throwRunTimeError(
-              "Graph::constructor: cannot find edge vertex to B");
-
-        const auto edge_A_to_B = Edge{A.key(), B.key()};
-        const auto weight_A_to_B = A_to_vertex.value() + vertex_to_B.value();
-
-        const auto edge_B_to_A = Edge{B.key(), A.key()};
-        const auto weight_B_to_A = B_to_vertex.value() + vertex_to_A.value();
-
-        m_edges.remove(A_to_vertex.key());
-        m_edges.remove(vertex_to_A.key());
-        m_edges.remove(B_to_vertex.key());
-        m_edges.remove(vertex_to_B.key());
-
-        m_edges[edge_A_to_B] = weight_A_to_B;
-        m_edges[edge_B_to_A] = weight_B_to_A;
-
-        A->parents.remove(vertex.key());
-        B->parents.remove(vertex.key());
-        A->children.remove(vertex.key());
-        B->children.remove(vertex.key());
-
-        A->parents << B.key();
-        A->children << B.key();
-        B->parents << A.key();
-        B->children << A.key();
+  QString solve() const {
+    const auto start = std::uint8_t{0};
+    auto remaining = 0u;
+    for (auto id = 1u; id < m_junctions.size(); ++id)
+      remaining += m_junctions[id].max_entering_length;
+
+    // Expands the top of the search tree breadth first, then hands the
+    // resulting paths to the threads
+    const auto nb_threads = common::nbHardwareThreads();
+    auto best = std::atomic<uint>{0};
+    auto paths = std::vector<Path>{Path{start, std::uint64_t{1}, 0u,
+                                        remaining}};
+    for (auto depth = 0; depth < 12 and not paths.empty() and
+                         paths.size() < 16u * nb_threads;
+         ++depth) {
+      auto next_paths = std::vector<Path>();
+      for (const auto &path : paths)
+        expand(path, best, [&next_paths](const Path &child) {
+          next_paths.push_back(child);
+        });
+      paths = std::move(next_paths);
+    }
+    common::parallelFor(
+        0, paths.size(),
+        [this, &paths, &best](std::size_t i) { search(paths[i], best); },
+        nb_threads);
+    return QString("%1").arg(best.load());
+  }
 
-        m_vertices.erase(vertex);
-        vertex = std::begin(m_vertices);
-      } else {
-        ++vertex;
+private:
+  static constexpr std::uint8_t end_id = 1u;
+
+  void addEdge(uint head, uint tail, uint length) {
+    auto &junction = m_junctions[head];
+    for (auto i = 0u; i < junction.nb_neighbors; ++i) {
+      if (junction.neighbors[i] == tail) {
+        junction.lengths[i] = std::max(junction.lengths[i], length);
+        return;
       }
     }
+    if (junction.nb_neighbors == 4u)
+      common::throwRunTimeError("Graph::addEdge: more than 4 neighbors");
+    junction.neighbors[junction.nb_neighbors] = static_cast<std::uint8_t>(tail);
+    junction.lengths[junction.nb_neighbors] = length;
+    ++junction.nb_neighbors;
+    auto &max_length = m_junctions[tail].max_entering_length;
+    max_length = std::max(max_length, length);
+  }
 
-    exportToCSV(
-        "/home/aboeuf/Projects/AdventOfCode/python/2023/day_23/after.txt");
+  static void updateBest(std::atomic<uint> &best, uint length) {
+    auto current = best.load(std::memory_order_relaxed);
+    while (length > current and
+           not best.compare_exchange_weak(current, length,
+                                          std::memory_order_relaxed)) {
+    }
   }
 
-  QString solve() const {
-    auto max_length = 0u;
-    auto Q = QQueue<Path>();
-    Q.enqueue(Path(m_grid.start()));
-    while (not Q.empty()) {
-      const auto current = Q.dequeue();
-      if (current.last == m_grid.end()) {
-        max_length = std::max(max_length, current.length);
-      } else {
-        const auto parent = m_vertices.find(current.last);
-        if (parent == std::end(m_vertices))
-          common::throwRunTimeError("Graph::solve: cannot find parent vertex");
-        for (auto child = std::begin(parent->children);
-             child != std::end(parent->children); ++child) {
-          if (not current.vertices.contains(*child)) {
-            const auto edge = m_edges.find(Edge(parent.key(), *child));
-            if (edge == std::end(m_edges))
-              common::throwRunTimeError("Graph::solve: cannot find edge");
-            Q.enqueue(Path(current, *child, edge.value()));
-          }
-        }
+  // Calls on_child on every extension of path worth exploring. The end is
+  // only reachable through one junction, so once there it is the only move.
+  template <typename Function>
+  void expand(const Path &path, std::atomic<uint> &best,
+              const Function &on_child) const {
+    if (path.last == end_id) {
+      updateBest(best, path.length);
+      return;
+    }
+    if (path.length + path.remaining <= best.load(std::memory_order_relaxed))
+      return;
+    const auto &junction = m_junctions[path.last];
+    for (auto i = 0u; i < junction.nb_neighbors; ++i) {
+      if (junction.neighbors[i] == end_id) {
+        updateBest(best, path.length + junction.lengths[i]);
+        return;
       }
     }
-    return QString("%1").arg(max_length);
+    for (auto i = 0u; i < junction.nb_neighbors; ++i) {
+      const auto next = junction.neighbors[i];
+      const auto bit = std::uint64_t{1} << next;
+      if (path.visited & bit)
+        continue;
+      on_child(Path{next, path.visited | bit, path.length + junction.lengths[i],
+                    path.remaining - m_junctions[next].max_entering_length});
+    }
   }
 
-  void exportToCSV(const QString &filepath) const {
-    QFile file(filepath);
-    if (not file.open(QIODevice::WriteOnly | QIODevice::Text))
-      common::throwInvalidArgumentError(
-          QString("Graph::exportToCSV: cannot open file \"%1\"").arg(filepath));
-    QTextStream out(&file);
-    for (auto edge = std::cbegin(m_edges); edge != std::cend(m_edges); ++edge)
-      out << edge.key().toString() + "|" << edge.value() << "\n";
-    file.close();
+  void search(const Path &path, std::atomic<uint> &best) const {
+    expand(path, best,
+           [this, &best](const Path &child) { search(child, best); });
   }
 
-private:
   Grid m_grid;
-  QHash<Vertex, Neighbors> m_vertices;
-  QHash<Edge, uint> m_edges;
+  std::vector<Vertex> m_positions{};
+  std::vector<Junction> m_junctions{};
 };
 
 } // namespace puzzle_2023_23
@@ -1,141 +1,192 @@
-#include <QQueue>
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <random>
 #include <solvers/2023/puzzle_2023_25.h>
 #include <solvers/common.h>
+#include <solvers/threadpool.h>
+#include <vector>
 
 namespace puzzle_2023_25 {
 
-struct Edge {
-  Edge() = default;
-  Edge(const QString &head, const QString &tail) : head{head}, tail{tail} {}
-  QString head{""};
-  QString tail{""};
+struct Cut {
+  uint size{0};
+  uint nb_nodes_on_source_side{0};
 };
 
-bool operator==(const Edge &lhs, const Edge &rhs) {
-  return (lhs.head == rhs.head and lhs.tail == rhs.tail) or
-         (lhs.head == rhs.tail and lhs.tail == rhs.head);
-}
-
-uint qHash(const Edge &edge) {
-  return std::min(qHash(QString("%1<->%2").arg(edge.head, edge.tail)),
-                  qHash(QString("%1<->%2").arg(edge.tail, edge.head)));
-}
+// Scratch space of one thread for the s-t flows. Each edge is a pair of
+// opposite arcs of capacity 1, and flow[arc] is in {-1, 0, 1}.
+struct FlowState {
+  std::vector<std::int8_t> flow{};
+  std::vector<uint> parent_arcs{};
+  std::vector<uint> stamps{};
+  std::vector<uint> queue{};
+  uint stamp{0};
+};
 
 class Graph {
 public:
   Graph(const QString &input) {
-    const auto lines = common::splitLines(input);
+    auto ids = QHash<QString, uint>();
+    const auto id = [&ids](const QString &name) {
+      const auto it = ids.constFind(name);
+      if (it != ids.cend())
+        return *it;
+      const auto new_id = static_cast<uint>(ids.size());
+      ids.insert(name, new_id);
+      return new_id;
+    };
+
+    auto edges = std::vector<std::pair<uint, uint>>();
+    const auto lines = common::splitLines(input, true);
     for (const auto &line : lines) {
       const auto splitted = common::splitValues(line, ':');
-      if (splitted.size() != 2)
-        common::throwInvalidArgumentError("Graph::constructor: bad split size");
-      const auto node = splitted[0];
-      if (not node.isEmpty()) {
-        const auto neighbors = common::splitValues(splitted[1].mid(1), ' ');
-        for (const auto &neighbor : neighbors) {
-          if (not neighbor.isEmpty()) {
-            m_data[node] << neighbor;
-            m_data[neighbor] << node;
-          }
-        }
-      }
+      if (splitted.size() != 2 or splitted[0].isEmpty())
+        common::throwInvalidArgumentError(
+            QString("Graph: invalid line \"%1\"").arg(line));
+      const auto node = id(splitted[0]);
+      for (const auto &neighbor : common::splitValues(splitted[1], ' '))
+        if (not neighbor.isEmpty())
+          edges.emplace_back(node, id(neighbor));
     }
-  }
+    m_nb_nodes = static_cast<uint>(ids.size());
 
-  QString minDegreeNode() const {
-    auto min_degree_node = QString("");
-    auto min_degree = std::numeric_limits<int>::max();
-    for (auto it = std::begin(m_data); it != std::end(m_data); ++it) {
-      if (it.value().size() < min_degree) {
-        min_degree = it.value().size();
-        min_degree_node = it.key();
-      }
+    // Compressed sparse rows, each arc knowing its opposite arc
+    m_offsets.assign(m_nb_nodes + 1, 0u);
+    for (const auto &[u, v] : edges) {
+      ++m_offsets[u + 1];
+      ++m_offsets[v + 1];
     }
-    return min_degree_node;
-  }
-
-  QSet<Edge> edges(const QString &node) const {
-    auto edge_set = QSet<Edge>{};
-    if (m_data.contains(node)) {
-      for (const auto &neighbor : m_data[node])
-        edge_set << Edge{node, neighbor};
+    for (auto node = 0u; node < m_nb_nodes; ++node)
+      m_offsets[node + 1] += m_offsets[node];
+    auto positions = std::vector<uint>(std::cbegin(m_offsets),
+                                       std::prev(std::cend(m_offsets)));
+    m_targets.resize(2 * std::size(edges));
+    m_opposite_arcs.resize(2 * std::size(edges));
+    for (const auto &[u, v] : edges) {
+      const auto uv = positions[u]++;
+      const auto vu = positions[v]++;
+      m_targets[uv] = v;
+      m_targets[vu] = u;
+      m_opposite_arcs[uv] = vu;
+      m_opposite_arcs[vu] = uv;
     }
-    return edge_set;
   }
 
-  QSet<QString> dominatingSet(const QString &start_with = QString("")) const {
-    const auto first = [&start_with, this]() -> QString {
-      if (start_with.isEmpty())
-        return m_data.begin().key();
-      if (not m_data.contains(start_with))
-        common::throwInvalidArgumentError(
-            QString("Graph::dominatingSet: cannot find starting node \"%1\"")
-                .arg(start_with));
-      return QString("");
-    }();
-    auto dominating_set = QSet<QString>{first};
-    auto dominated_nodes = m_data[first];
-    auto remaining_nodes =
-        QSet<QString>{std::begin(m_data.keys()), std::end(m_data.keys())};
-    remaining_nodes -= dominating_set;
-    remaining_nodes -= dominated_nodes;
-    while (not remaining_nodes.empty()) {
-      const auto node = *remaining_nodes.begin();
-      remaining_nodes.erase(remaining_nodes.begin());
-      const auto undominated_neighbors = m_data[node] - dominating_set;
-      dominating_set << node;
-      dominated_nodes |= undominated_neighbors;
-      remaining_nodes -= undominated_neighbors;
+  uint nbNodes() const { return m_nb_nodes; }
+
+  // Augments along shortest paths until the flow from s to t exceeds bound.
+  // When the returned flow is at most bound, it is the maximum flow and the
+  // nodes stamped by the last search are the source side of a minimum cut.
+  uint maxFlow(uint s, uint t, uint bound, FlowState &state) const {
+    state.flow.assign(std::size(m_targets), 0);
+    state.parent_arcs.resize(m_nb_nodes);
+    state.stamps.resize(m_nb_nodes, 0u);
+    auto flow = 0u;
+    while (flow <= bound) {
+      if (not findAugmentingPath(s, t, state))
+        return flow;
+      for (auto node = t; node != s;) {
+        const auto arc = state.parent_arcs[node];
+        ++state.flow[arc];
+        --state.flow[m_opposite_arcs[arc]];
+        node = m_targets[m_opposite_arcs[arc]];
+      }
+      ++flow;
     }
-    return dominating_set;
+    return flow;
   }
 
-  uint edmondKarpMaxFlow(const QString &s, const QString &t) const {
-    return 0u;
+  // Every cut separates node 0 from some other node, so the global minimum
+  // cut is the smallest of the s-t cuts from node 0, each flow being bounded
+  // by the best cut found so far. The targets are shuffled, since nodes of
+  // the same component tend to be listed together, and split across threads,
+  // which all stop once a cut of at most target_size edges is found.
+  Cut minimumCut(uint target_size = 0) const {
+    if (m_nb_nodes < 2)
+      common::throwInvalidArgumentError("Graph: not enough nodes to cut");
+    auto best = Cut{m_offsets[1] - m_offsets[0], 1u};
+    auto best_size = std::atomic<uint>{best.size};
+    auto mutex = std::mutex();
+    auto targets = std::vector<uint>(m_nb_nodes - 1);
+    std::iota(std::begin(targets), std::end(targets), 1u);
+    std::shuffle(std::begin(targets), std::end(targets),
+                 std::mt19937{m_nb_nodes});
+    const auto nb_threads = std::min<std::size_t>(common::nbHardwareThreads(),
+                                                  m_nb_nodes - 1);
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          auto state = FlowState();
+          for (auto i = thread; i < std::size(targets); i += nb_threads) {
+            const auto size = best_size.load();
+            if (size <= target_size)
+              return;
+            const auto flow = maxFlow(0u, targets[i], size - 1, state);
+            if (flow >= size)
+              continue;
+            const auto nb_nodes = static_cast<uint>(
+                std::count(std::cbegin(state.stamps), std::cend(state.stamps),
+                           state.stamp));
+            const auto lock = std::lock_guard<std::mutex>(mutex);
+            if (flow < best.size) {
+              best = Cut{flow, nb_nodes};
+              best_size = flow;
+            }
+          }
+        },
+        nb_threads);
+    return best;
   }
 
-  QSet<Edge> minimumSTEdgeCut(const QString &s, const QString &t) const {
-    return QSet<Edge>{};
+  QString solve() const {
+    const auto cut = minimumCut(3u);
+    const auto product = static_cast<unsigned long long>(
+                             cut.nb_nodes_on_source_side) *
+                         (m_nb_nodes - cut.nb_nodes_on_source_side);
+    return QString("%1").arg(product);
   }
 
-  QSet<Edge> minimumEdgeCut() const {
-    const auto min_degree_node = minDegreeNode();
-    auto min_cut = edges(min_degree_node);
-    auto dominating_set = [this]() {
-      for (auto it = std::begin(m_data); it != std::end(m_data); ++it) {
-        const auto d_set = dominatingSet(it.key());
-        if (d_set.size() > 1)
-          return d_set;
+private:
+  bool findAugmentingPath(uint s, uint t, FlowState &state) const {
+    if (++state.stamp == 0u) {
+      std::fill(std::begin(state.stamps), std::end(state.stamps), 0u);
+      state.stamp = 1u;
+    }
+    state.queue.clear();
+    state.queue.push_back(s);
+    state.stamps[s] = state.stamp;
+    for (auto head = std::size_t{0}; head < std::size(state.queue); ++head) {
+      const auto node = state.queue[head];
+      for (auto arc = m_offsets[node]; arc < m_offsets[node + 1]; ++arc) {
+        const auto next = m_targets[arc];
+        if (state.flow[arc] > 0 or state.stamps[next] == state.stamp)
+          continue;
+        state.stamps[next] = state.stamp;
+        state.parent_arcs[next] = arc;
+        if (next == t)
+          return true;
+        state.queue.push_back(next);
       }
-      return QSet<QString>{};
-    }();
-    if (dominating_set.size() < 2)
-      return min_cut;
-    const auto v = *dominating_set.begin();
-    dominating_set.erase(dominating_set.begin());
-    for (const auto &w : dominating_set) {
-      auto this_cut = minimumSTEdgeCut(v, w);
-      if (this_cut.size() <= min_cut.size())
-        std::swap(min_cut, this_cut);
     }
-    return min_cut;
+    return false;
   }
 
-  QString solve() { return "Default"; }
-
-private:
-  QHash<QString, QSet<QString>> m_data;
+  uint m_nb_nodes{0};
+  std::vector<uint> m_offsets{};
+  std::vector<uint> m_targets{};
+  std::vector<uint> m_opposite_arcs{};
 };
 
 } // namespace puzzle_2023_25
 
 void Solver_2023_25_1::solve(const QString &input) {
-  auto graph = puzzle_2023_25::Graph{input};
+  const auto graph = puzzle_2023_25::Graph{input};
   emit finished(graph.solve());
 }
 
-void Solver_2023_25_2::solve(const QString &input) {
-  auto graph = puzzle_2023_25::Graph{input};
-  emit finished(graph.solve());
+void Solver_2023_25_2::solve(const QString &) {
+  emit finished("No second puzzle on day 25");
 }
@@ -1,67 +1,27 @@
+#include <algorithm>
+#include <cstdint>
 #include <solvers/2024/puzzle_2024_06.h>
 #include <solvers/common.h>
-#include <unordered_set>
-
-#include <iostream>
+#include <solvers/threadpool.h>
+#include <vector>
 
 namespace puzzle_2024_06 {
 
-struct Coordinates {
-  Coordinates() = default;
-
-  Coordinates(int row, int column) : row{row}, column{column} {}
-
-  void operator+=(const Coordinates &other) {
-    row += other.row;
-    column += other.column;
-  }
-
-  void operator-=(const Coordinates &other) {
-    row -= other.row;
-    column -= other.column;
-  }
+// Up, right, down, left: turning clockwise increments the direction
+const int row_steps[4] = {-1, 0, 1, 0};
+const int column_steps[4] = {0, 1, 0, -1};
 
-  bool operator==(const Coordinates &other) const {
-    return row == other.row and column == other.column;
-  }
-
-  bool operator!=(const Coordinates &other) const {
-    return row != other.row or column != other.column;
-  }
-
-  void rotateClockwise() {
-    std::swap(row, column);
-    column *= -1;
-  }
+const auto exit_cell = -1;
 
-  int row{0};
-  int column{0};
+struct State {
+  int cell{0};
+  int direction{0};
 };
 
-inline std::size_t normalize(const int value) {
-  return value < 0 ? 2u * static_cast<std::size_t>(-value) + 1u
-                   : 2u * static_cast<std::size_t>(value);
-}
-
-} // namespace puzzle_2024_06
-
-template <> struct std::hash<puzzle_2024_06::Coordinates> {
-  std::size_t operator()(const puzzle_2024_06::Coordinates &coordinates) const {
-    const auto normalized_row = puzzle_2024_06::normalize(coordinates.row);
-    const auto normalized_column =
-        puzzle_2024_06::normalize(coordinates.column);
-    const auto sum = normalized_row + normalized_column;
-    return sum * (sum + 1u) / 2 + normalized_column;
-  }
-};
-
-namespace puzzle_2024_06 {
-
-using Record = std::unordered_map<Coordinates, std::unordered_set<Coordinates>>;
-
-struct SimulationResult {
-  bool is_looping{false};
-  Record record{};
+struct Candidate {
+  int obstacle{0};
+  // State of the guard right before it first walks into the obstacle
+  State start{};
 };
 
 class Map {
@@ -73,6 +33,7 @@ public:
       throw std::invalid_argument("puzzle_2024_06::Map: empty map");
     }
     m_nb_columns = lines.front().size();
+    m_obstacles.assign((m_nb_rows * m_nb_columns + 63) / 64, 0u);
     auto gard_position_found = false;
     auto row = 0;
     for (const auto &line : lines) {
@@ -88,32 +49,23 @@ public:
       auto column = 0;
       for (const auto &c : line) {
         if (c == '#') {
-          m_obstacles.insert(Coordinates{row, column});
+          const auto index = cell(row, column);
+          m_obstacles[index / 64] |= std::uint64_t{1} << (index % 64);
         } else if (c == '^' or c == '>' or c == 'v' or c == '<') {
           if (gard_position_found) {
             throw std::invalid_argument(
                 QString("puzzle_2024_06::Map: multiple gard position detected "
                         "(line %1, column %2). Previous position was detected "
-                        "at (line %3, column %4)"
-                        "column %3")
-                    .arg(m_initial_gard_position.row + 1u)
-                    .arg(m_initial_gard_position.column + 1u)
+                        "at (line %3, column %4)")
                     .arg(row + 1u)
                     .arg(column + 1u)
+                    .arg(m_start.cell / m_nb_columns + 1u)
+                    .arg(m_start.cell % m_nb_columns + 1u)
                     .toStdString());
           }
           gard_position_found = true;
-          m_initial_gard_position.row = row;
-          m_initial_gard_position.column = column;
-          if (c == '^') {
-            m_initial_gard_orientation.row = -1;
-          } else if (c == '>') {
-            m_initial_gard_orientation.column = 1;
-          } else if (c == 'v') {
-            m_initial_gard_orientation.row = 1;
-          } else {
-            m_initial_gard_orientation.column = -1;
-          }
+          m_start.cell = cell(row, column);
+          m_start.direction = c == '^' ? 0 : c == '>' ? 1 : c == 'v' ? 2 : 3;
         } else if (c != '.') {
           throw std::invalid_argument(
               QString("puzzle_2024_06::Map: invalid character '%1' at (line "
@@ -131,59 +83,140 @@ public:
       throw std::invalid_argument(
           "puzzle_2024_06::Map: cannot find gard position");
     }
+    computeJumps();
   }
 
-  SimulationResult runSimulation(
-      const std::optional<Coordinates> &extra_obstacle = std::nullopt) const {
-    auto result = SimulationResult{};
-    auto gard_position = m_initial_gard_position;
-    auto gard_orientation = m_initial_gard_orientation;
-    result.record[gard_position].insert(gard_orientation);
-    for (;;) {
-      gard_position += gard_orientation;
-      while (
-          m_obstacles.find(gard_position) != std::cend(m_obstacles) or
-          (extra_obstacle.has_value() and *extra_obstacle == gard_position)) {
-        gard_position -= gard_orientation;
-        gard_orientation.rotateClockwise();
-        gard_position += gard_orientation;
-      }
-      if (gard_position.row < 0 or gard_position.row >= m_nb_rows or
-          gard_position.column < 0 or gard_position.column >= m_nb_columns) {
-        return result;
-      }
-      auto &orientations = result.record[gard_position];
-      if (not orientations.insert(gard_orientation).second) {
-        result.is_looping = true;
-        return result;
+  QString solveOne() const { return QString("%1").arg(walk().size() + 1u); }
+
+  QString solveTwo() const {
+    const auto candidates = walk();
+    const auto nb_threads = std::max(
+        std::size_t{1}, std::min(common::nbHardwareThreads(),
+                                 candidates.size() / 64u));
+    auto nb_loops = std::vector<std::size_t>(nb_threads, 0u);
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          auto stamps =
+              std::vector<std::uint32_t>(4u * m_nb_rows * m_nb_columns, 0u);
+          auto stamp = std::uint32_t{0};
+          for (auto i = thread; i < candidates.size(); i += nb_threads)
+            if (isLooping(candidates[i], stamps, ++stamp))
+              ++nb_loops[thread];
+        },
+        nb_threads);
+    auto res = std::size_t{0};
+    for (const auto n : nb_loops)
+      res += n;
+    return QString("%1").arg(res);
+  }
+
+private:
+  int cell(int row, int column) const { return row * m_nb_columns + column; }
+
+  bool isObstacle(int index) const {
+    return (m_obstacles[index / 64] >> (index % 64)) & 1u;
+  }
+
+  // m_jumps[4 * cell + direction] is the last cell the guard reaches before
+  // bumping into an obstacle, or exit_cell if it leaves the map
+  void computeJumps() {
+    m_jumps.assign(4u * m_nb_rows * m_nb_columns, exit_cell);
+    for (auto direction = 0; direction < 4; ++direction) {
+      const auto vertical = row_steps[direction] != 0;
+      const auto forward = row_steps[direction] + column_steps[direction] > 0;
+      const auto nb_lines = vertical ? m_nb_columns : m_nb_rows;
+      const auto length = vertical ? m_nb_rows : m_nb_columns;
+      for (auto line = 0; line < nb_lines; ++line) {
+        auto stop = exit_cell;
+        // Walks against the direction so that the stop cell is known
+        for (auto k = 0; k < length; ++k) {
+          const auto position = forward ? length - 1 - k : k;
+          const auto index =
+              vertical ? cell(position, line) : cell(line, position);
+          if (isObstacle(index))
+            stop = exit_cell - 1;
+          else {
+            if (stop == exit_cell - 1)
+              stop = index;
+            m_jumps[4 * index + direction] = stop;
+          }
+        }
       }
     }
   }
 
-  QString solveOne() const {
-    const auto result = runSimulation();
-    return QString("%1").arg(std::size(result.record));
+  // Cells of the original path in visiting order, without the start cell,
+  // each with the state from which the guard first enters it
+  std::vector<Candidate> walk() const {
+    // Bit d of visited[cell] is set once the guard stood there facing d
+    auto visited = std::vector<std::uint8_t>(m_nb_rows * m_nb_columns, 0u);
+    auto candidates = std::vector<Candidate>();
+    auto state = m_start;
+    visited[state.cell] = 1u << state.direction;
+    for (;;) {
+      const auto row = state.cell / m_nb_columns + row_steps[state.direction];
+      const auto column =
+          state.cell % m_nb_columns + column_steps[state.direction];
+      if (row < 0 or row >= m_nb_rows or column < 0 or column >= m_nb_columns)
+        return candidates;
+      const auto next = cell(row, column);
+      if (isObstacle(next)) {
+        state.direction = (state.direction + 1) % 4;
+      } else {
+        if (visited[next] == 0u)
+          candidates.push_back(Candidate{next, state});
+        state.cell = next;
+      }
+      const auto mask = static_cast<std::uint8_t>(1u << state.direction);
+      if (visited[state.cell] & mask)
+        return candidates;
+      visited[state.cell] |= mask;
+    }
   }
 
-  QString solveTwo() const {
-    auto visited_positions = runSimulation().record;
-    visited_positions.erase(m_initial_gard_position);
-    auto nb_loops = 0u;
-    for (const auto &[extra_obstacle, _] : visited_positions) {
-      const auto result = runSimulation(extra_obstacle);
-      if (result.is_looping) {
-        ++nb_loops;
+  // Jumps from turn to turn, stopping short of the extra obstacle when it
+  // lies on the current segment
+  bool isLooping(const Candidate &candidate, std::vector<std::uint32_t> &stamps,
+                 std::uint32_t stamp) const {
+    const auto obstacle_row = candidate.obstacle / m_nb_columns;
+    const auto obstacle_column = candidate.obstacle % m_nb_columns;
+    auto state = candidate.start;
+    for (;;) {
+      const auto row = state.cell / m_nb_columns;
+      const auto column = state.cell % m_nb_columns;
+      auto stop = m_jumps[4 * state.cell + state.direction];
+      const auto stop_distance =
+          stop == exit_cell ? m_nb_rows + m_nb_columns
+                            : std::abs(stop / m_nb_columns - row) +
+                                  std::abs(stop % m_nb_columns - column);
+      const auto obstacle_distance =
+          (obstacle_row - row) * row_steps[state.direction] +
+          (obstacle_column - column) * column_steps[state.direction];
+      const auto on_line = row_steps[state.direction] == 0
+                               ? obstacle_row == row
+                               : obstacle_column == column;
+      if (on_line and obstacle_distance > 0 and
+          obstacle_distance <= stop_distance) {
+        stop = candidate.obstacle -
+               row_steps[state.direction] * m_nb_columns -
+               column_steps[state.direction];
       }
+      if (stop == exit_cell)
+        return false;
+      auto &visit = stamps[4 * stop + state.direction];
+      if (visit == stamp)
+        return true;
+      visit = stamp;
+      state = State{stop, (state.direction + 1) % 4};
     }
-    return QString("%1").arg(nb_loops);
   }
 
-private:
-  std::unordered_set<Coordinates> m_obstacles;
+  std::vector<std::uint64_t> m_obstacles{};
+  std::vector<int> m_jumps{};
   int m_nb_rows;
   int m_nb_columns;
-  Coordinates m_initial_gard_position;
-  Coordinates m_initial_gard_orientation;
+  State m_start{};
 };
 
 } // namespace puzzle_2024_06
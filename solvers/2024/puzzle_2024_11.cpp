@@ -1,89 +1,146 @@
 #include <solvers/2024/puzzle_2024_11.h>
 #include <solvers/common.h>
 
-#include <deque>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <vector>
 
 namespace puzzle_2024_11 {
 
 using Int = unsigned long long;
 
-struct Stone {
-  Stone(Int value) {
-    if (value == Int{0}) {
-      children.push_back(Int{1});
-      return;
-    }
-    const auto str = QString("%1").arg(value);
-    if (str.size() % 2 != 0) {
-      children.push_back(Int{2024} * value);
-      return;
-    }
-    const auto half = str.size() / 2;
-    children.push_back(str.midRef(0, half).toULongLong());
-    children.push_back(str.midRef(half).toULongLong());
-  }
+constexpr auto powers_of_ten = [] {
+  auto powers = std::array<Int, 20>();
+  powers[0] = Int{1};
+  for (auto i = std::size_t{1}; i < std::size(powers); ++i)
+    powers[i] = Int{10} * powers[i - 1];
+  return powers;
+}();
 
-  std::deque<Int> children;
-  std::unordered_map<Int, Int> nb_chidren_after_n_steps;
-};
+inline std::size_t nbDigits(Int value) {
+  auto nb_digits = std::size_t{1};
+  while (nb_digits < std::size(powers_of_ten) and
+         value >= powers_of_ten[nb_digits])
+    ++nb_digits;
+  return nb_digits;
+}
 
-class Stones {
+// Open addressing table from stone values to multiplicities. Clearing it
+// keeps its capacity, so that it can be reused from one blink to the next.
+class StoneCounts {
 public:
-  Stones(const QString &input)
-      : m_initial_stones{common::toVecULongLong(input, ' ')} {
-    for (const auto value : m_initial_stones) {
-      addStone(value);
-    }
+  StoneCounts(std::size_t capacity = 1u << 13) { reserve(capacity); }
+
+  std::size_t size() const { return m_size; }
+
+  void clear() {
+    std::fill(std::begin(m_values), std::end(m_values), empty);
+    m_size = 0;
   }
 
-  Int getNbChidrenAfterNSteps(Int nb_steps) {
-    auto sum = Int{0};
-    for (const auto value : m_initial_stones) {
-      sum += getNbChidrenAfterNSteps(value, nb_steps);
+  void add(Int value, Int count) {
+    if (2 * (m_size + 1) > std::size(m_values))
+      reserve(2 * std::size(m_values));
+    auto slot = find(value);
+    if (m_values[slot] == empty) {
+      m_values[slot] = value;
+      m_counts[slot] = count;
+      ++m_size;
+    } else {
+      m_counts[slot] += count;
     }
-    return sum;
+  }
+
+  template <typename Function> void forEach(Function function) const {
+    for (auto slot = std::size_t{0}; slot < std::size(m_values); ++slot)
+      if (m_values[slot] != empty)
+        function(m_values[slot], m_counts[slot]);
   }
 
 private:
-  void addStone(Int value) {
-    auto it = m_generated_stones.insert(std::make_pair(value, Stone(value)));
-    if (it.second) {
-      for (const auto child_value : it.first->second.children) {
-        addStone(child_value);
+  static constexpr auto empty = ~Int{0};
+
+  std::size_t find(Int value) const {
+    auto slot = static_cast<std::size_t>((value * 0x9e3779b97f4a7c15ull) >>
+                                         m_shift);
+    while (m_values[slot] != empty and m_values[slot] != value)
+      slot = (slot + 1) & (std::size(m_values) - 1);
+    return slot;
+  }
+
+  void reserve(std::size_t capacity) {
+    auto values = std::move(m_values);
+    auto counts = std::move(m_counts);
+    auto nb_bits = 1;
+    while ((std::size_t{1} << nb_bits) < capacity)
+      ++nb_bits;
+    m_shift = 64 - nb_bits;
+    m_values.assign(std::size_t{1} << nb_bits, empty);
+    m_counts.assign(std::size_t{1} << nb_bits, Int{0});
+    m_size = 0;
+    for (auto slot = std::size_t{0}; slot < std::size(values); ++slot) {
+      if (values[slot] != empty) {
+        const auto new_slot = find(values[slot]);
+        m_values[new_slot] = values[slot];
+        m_counts[new_slot] = counts[slot];
+        ++m_size;
       }
     }
   }
 
-  Int getNbChidrenAfterNSteps(Int parent_value, Int nb_steps) {
-    if (nb_steps == Int{0}) {
-      return Int{1};
-    }
-    auto &parent_stone = m_generated_stones.find(parent_value)->second;
-    const auto it = parent_stone.nb_chidren_after_n_steps.find(nb_steps);
-    if (it != std::cend(parent_stone.nb_chidren_after_n_steps)) {
-      return it->second;
-    }
-    auto &result = parent_stone.nb_chidren_after_n_steps[nb_steps];
-    result = Int{0};
-    for (const auto child_value : parent_stone.children) {
-      result += getNbChidrenAfterNSteps(child_value, nb_steps - Int{1});
+  std::vector<Int> m_values{};
+  std::vector<Int> m_counts{};
+  std::size_t m_size{0};
+  int m_shift{64};
+};
+
+class Stones {
+public:
+  Stones(const QString &input) {
+    for (const auto value : common::toVecULongLong(input, ' '))
+      m_initial_stones.add(value, Int{1});
+  }
+
+  // Stones with the same value evolve the same way, so only the multiplicity
+  // of each value is tracked. Counts wrap modulo 2^64 for very long runs.
+  Int nbStonesAfterNBlinks(uint nb_blinks) const {
+    auto current = m_initial_stones;
+    auto next = StoneCounts();
+    for (auto blink = 0u; blink < nb_blinks; ++blink) {
+      next.clear();
+      current.forEach([&next](Int value, Int count) {
+        if (value == Int{0}) {
+          next.add(Int{1}, count);
+          return;
+        }
+        const auto nb_digits = nbDigits(value);
+        if (nb_digits % 2 != 0) {
+          next.add(Int{2024} * value, count);
+          return;
+        }
+        const auto half = powers_of_ten[nb_digits / 2];
+        next.add(value / half, count);
+        next.add(value % half, count);
+      });
+      std::swap(current, next);
     }
-    return result;
+    auto sum = Int{0};
+    current.forEach([&sum](Int, Int count) { sum += count; });
+    return sum;
   }
 
-  QVector<Int> m_initial_stones;
-  std::unordered_map<Int, Stone> m_generated_stones;
+private:
+  StoneCounts m_initial_stones{};
 };
 
 } // namespace puzzle_2024_11
 
 void Solver_2024_11_1::solve(const QString &input) {
-  auto stones = puzzle_2024_11::Stones(input);
-  emit finished(QString("%1").arg(stones.getNbChidrenAfterNSteps(25u)));
+  const auto stones = puzzle_2024_11::Stones(input);
+  emit finished(QString("%1").arg(stones.nbStonesAfterNBlinks(25u)));
 }
 
 void Solver_2024_11_2::solve(const QString &input) {
-  auto stones = puzzle_2024_11::Stones(input);
-  emit finished(QString("%1").arg(stones.getNbChidrenAfterNSteps(75u)));
+  const auto stones = puzzle_2024_11::Stones(input);
+  emit finished(QString("%1").arg(stones.nbStonesAfterNBlinks(75u)));
 }
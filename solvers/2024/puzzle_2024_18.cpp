@@ -1,4 +1,3 @@
-#include <functional>
 #include <limits>
 #include <solvers/2024/puzzle_2024_18.h>
 #include <solvers/common.h>
@@ -55,39 +54,6 @@ private:
   std::vector<std::vector<Tile>> m_grid;
 };
 
-using Compare = std::function<bool(const QPoint &, const QPoint &)>;
-
-class OpenSet {
-public:
-  OpenSet(const Compare &compare, int grid_size) : m_compare{compare} {
-    m_heap.reserve((grid_size + 1) * (grid_size + 1));
-    std::make_heap(std::begin(m_heap), std::end(m_heap), m_compare);
-  }
-
-  bool empty() const { return std::empty(m_heap); }
-
-  QPoint pop() {
-    const auto point = m_heap.front();
-    m_unique.remove(point);
-    std::pop_heap(std::begin(m_heap), std::end(m_heap), m_compare);
-    m_heap.pop_back();
-    return point;
-  }
-
-  void push(const QPoint &point) {
-    if (not m_unique.contains(point)) {
-      m_unique.insert(point);
-      m_heap.push_back(point);
-    }
-    std::push_heap(std::begin(m_heap), std::end(m_heap), m_compare);
-  }
-
-private:
-  Compare m_compare;
-  std::vector<QPoint> m_heap;
-  QSet<QPoint> m_unique;
-};
-
 class MemorySpace {
 public:
   MemorySpace(const QString &input, int size) : m_size(size) {
@@ -153,15 +119,12 @@ private:
                                     uint time) const {
     auto result = std::make_pair(false, Grid(goal, m_size));
     auto &grid = result.second;
-    const auto compare = [&grid](const QPoint &lhs, const QPoint &rhs) {
-      return grid.get(rhs).cost() < grid.get(lhs).cost();
-    };
-    auto open_set = OpenSet(compare, m_size);
+    auto open_set = common::BucketOpenSet<QPoint, uint>();
     grid.get(start).accumulated_cost = 0u;
-    open_set.push(start);
+    open_set.push(start, grid.get(start).cost());
 
-    while (not open_set.empty()) {
-      const auto position = open_set.pop();
+    while (const auto current = open_set.pop()) {
+      const auto position = current->first;
       if (position == goal) {
         result.first = true;
         return result;
@@ -175,7 +138,7 @@ private:
               next_accumulated_cost < *neighbor_tile.accumulated_cost) {
             neighbor_tile.accumulated_cost = next_accumulated_cost;
             neighbor_tile.previous = position;
-            open_set.push(neighbor_postion);
+            open_set.push(neighbor_postion, neighbor_tile.cost());
           }
         }
       }
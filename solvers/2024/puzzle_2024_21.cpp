@@ -1,4 +1,3 @@
-#include <functional>
 #include <limits>
 #include <solvers/2024/puzzle_2024_21.h>
 #include <solvers/common.h>
@@ -33,38 +32,6 @@ const auto numeric_layout = []() {
   return layout;
 }();
 
-using Compare = std::function<bool(const QChar &, const QChar &)>;
-
-class OpenSet {
-public:
-  OpenSet(const Compare &compare, int size) : m_compare{compare} {
-    m_heap.reserve(size);
-  }
-
-  bool empty() const { return std::empty(m_heap); }
-
-  QChar pop() {
-    const auto point = m_heap.front();
-    std::pop_heap(std::begin(m_heap), std::end(m_heap), m_compare);
-    m_heap.pop_back();
-    m_unique.remove(point);
-    return point;
-  }
-
-  void push(const QChar &point) {
-    if (not m_unique.contains(point)) {
-      m_unique.insert(point);
-      m_heap.push_back(point);
-    }
-    std::push_heap(std::begin(m_heap), std::end(m_heap), m_compare);
-  }
-
-private:
-  Compare m_compare;
-  std::vector<QChar> m_heap;
-  QSet<QChar> m_unique;
-};
-
 using SequenceMap = QHash<QChar, QHash<QChar, QSet<QString>>>;
 
 class Keypad {
@@ -99,15 +66,12 @@ public:
       const auto get_cost = [&cost_map](const QChar &c) {
         return cost_map.value(c, std::numeric_limits<uint>::max());
       };
-      const auto compare = [&get_cost](const QChar &lhs, const QChar &rhs) {
-        return get_cost(rhs) < get_cost(lhs);
-      };
-      auto open_set = OpenSet(compare, m_characters.size());
+      auto open_set = common::HeapOpenSet<QChar, uint>();
       cost_map[start] = 0u;
       m_sequence_map[start][start].insert("A");
-      open_set.push(start);
-      while (not open_set.empty()) {
-        const auto current = open_set.pop();
+      open_set.push(start, 0u);
+      while (const auto top = open_set.pop()) {
+        const auto current = top->first;
         const auto current_position = position(current);
         const auto alternative_cost = cost_map[current] + 1u;
         for (auto it = cardinal_directions.cbegin();
@@ -129,7 +93,7 @@ public:
                         .arg(it.value()));
               }
               if (alternative_cost < next_cost) {
-                open_set.push(next);
+                open_set.push(next, alternative_cost);
               }
             }
           }
@@ -1,123 +1,123 @@
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <solvers/2024/puzzle_2024_22.h>
 #include <solvers/common.h>
+#include <solvers/threadpool.h>
+#include <vector>
 
 namespace puzzle_2024_22 {
 
 using Int = unsigned long long;
+using Secret = std::uint32_t;
 
-constexpr auto sequence_size = std::size_t{4u};
 constexpr auto nb_secret_numbers = 2000u;
-
-inline Int multiply(const Int secret_number, Int operand) {
-  return ((secret_number * operand) ^ secret_number) % Int{16777216};
-}
-
-inline Int divide(const Int secret_number, Int operand) {
-  return ((secret_number / operand) ^ secret_number) % Int{16777216};
-}
-
-inline Int getNextSecretNumber(const Int secret_number) {
-  return multiply(divide(multiply(secret_number, Int{64}), Int{32}), Int{2048});
+constexpr auto sequence_size = 4u;
+constexpr auto secret_mask = Secret{16777216 - 1};
+
+// A sequence of four price changes, each in [-9, 9], is a base 19 number
+constexpr auto nb_changes = 19u;
+constexpr auto nb_sequences = nb_changes * nb_changes * nb_changes * nb_changes;
+
+// Buyers are simulated nb_lanes at a time so that the xorshift steps map onto
+// vector registers
+constexpr auto nb_lanes = std::size_t{8};
+using Lanes = std::array<Secret, nb_lanes>;
+constexpr auto lane_mask = (1u << nb_lanes) - 1;
+
+inline Secret getNextSecretNumber(Secret secret_number) {
+  secret_number = ((secret_number << 6) ^ secret_number) & secret_mask;
+  secret_number = ((secret_number >> 5) ^ secret_number) & secret_mask;
+  return ((secret_number << 11) ^ secret_number) & secret_mask;
 }
 
-inline int getLastDigit(const Int n) {
-  const auto str = QString("%1").arg(n);
-  return str.midRef(str.length() - 1).toInt();
-}
-
-class Sequence {
-public:
-  std::size_t size() const { return std::size(m_sequence); }
-
-  std::deque<int>::const_iterator begin() const {
-    return std::cbegin(m_sequence);
-  }
-  std::deque<int>::const_iterator end() const { return std::cend(m_sequence); }
-
-  void append(const int value) {
-    m_sequence.push_back(value);
-    if (std::size(m_sequence) > sequence_size) {
-      m_sequence.pop_front();
-    }
-  }
-
-private:
-  using Int = unsigned long long;
-  std::deque<int> m_sequence;
-};
-
-inline bool operator==(const Sequence &lhs, const Sequence &rhs) {
-  if (lhs.size() == rhs.size()) {
-    auto lhs_it = lhs.begin();
-    auto rhs_it = rhs.begin();
-    while (lhs_it != lhs.end() and rhs_it != rhs.end()) {
-      if (*lhs_it != *rhs_it) {
-        return false;
-      }
-      ++lhs_it;
-      ++rhs_it;
-    }
-  }
-  return true;
-}
-
-inline uint qHash(const Sequence &sequence) {
-  auto str = QString("");
-  for (auto it = sequence.begin(); it != sequence.end(); ++it) {
-    str += QString("%1").arg(*it);
-    if (std::next(it) != sequence.end()) {
-      str += ",";
-    }
-  }
-  return qHash(str);
-}
-
-struct Price {
-  int nb_bananas{0};
-  QSet<std::size_t> buyers{};
+// Totals of one thread. For each sequence, seen holds the index + 1 of the
+// last block of buyers that sold on it in its high bits and the lanes of that
+// block that did in its low byte, so that only the first occurrence per buyer
+// counts.
+struct Market {
+  std::vector<std::uint32_t> nb_bananas =
+      std::vector<std::uint32_t>(nb_sequences, 0u);
+  std::vector<std::uint32_t> seen =
+      std::vector<std::uint32_t>(nb_sequences, 0u);
+  Int secret_numbers_sum{0};
 };
 
 class Prices {
 public:
   Prices(const QString &input) {
-    auto prices = QHash<Sequence, Price>();
-    const auto lines = common::splitLines(input);
-    auto buyer_index = 0u;
+    auto secret_numbers = std::vector<Secret>();
     auto ok = true;
-    for (const auto &line : lines) {
-      auto secret_number = line.toULongLong(&ok);
-      auto previous = getLastDigit(secret_number);
-      if (ok) {
-        auto sequence = Sequence();
-        for (auto i = 0u; i < nb_secret_numbers; ++i) {
-          secret_number = getNextSecretNumber(secret_number);
-          const auto current = getLastDigit(secret_number);
-          sequence.append(current - previous);
-          previous = current;
-          if (sequence.size() == sequence_size) {
-            auto &price = prices[sequence];
-            if (not price.buyers.contains(buyer_index)) {
-              price.nb_bananas += current;
-              price.buyers.insert(buyer_index);
-            }
-          }
-        }
-        m_secret_numbers_sum += secret_number;
-        ++buyer_index;
-      }
+    for (const auto &line : common::splitLines(input)) {
+      const auto secret_number = line.toULongLong(&ok);
+      if (ok)
+        secret_numbers.push_back(static_cast<Secret>(secret_number));
     }
-    for (auto it = std::cbegin(prices); it != std::cend(prices); ++it) {
-      m_max_nb_bananas = std::max(m_max_nb_bananas, it.value().nb_bananas);
+
+    const auto nb_blocks = (secret_numbers.size() + nb_lanes - 1) / nb_lanes;
+    const auto nb_threads = std::max(
+        std::size_t{1}, std::min(common::nbHardwareThreads(), nb_blocks / 8));
+    auto markets = std::vector<Market>(nb_threads);
+    common::parallelFor(
+        0, nb_threads,
+        [&](std::size_t thread) {
+          for (auto block = thread; block < nb_blocks; block += nb_threads)
+            simulate(secret_numbers, block, markets[thread]);
+        },
+        nb_threads);
+
+    for (const auto &market : markets)
+      m_secret_numbers_sum += market.secret_numbers_sum;
+    for (auto sequence = 0u; sequence < nb_sequences; ++sequence) {
+      auto nb_bananas = 0u;
+      for (const auto &market : markets)
+        nb_bananas += market.nb_bananas[sequence];
+      m_max_nb_bananas = std::max(m_max_nb_bananas, nb_bananas);
     }
   }
 
   Int secretNumbersSum() const { return m_secret_numbers_sum; }
-  int maxNbBananas() const { return m_max_nb_bananas; }
+  uint maxNbBananas() const { return m_max_nb_bananas; }
 
 private:
+  static void simulate(const std::vector<Secret> &secret_numbers,
+                       std::size_t block, Market &market) {
+    const auto first = block * nb_lanes;
+    const auto stamp = static_cast<std::uint32_t>(block + 1) << nb_lanes;
+    const auto nb_buyers =
+        std::min(nb_lanes, std::size(secret_numbers) - first);
+    auto secrets = Lanes();
+    auto prices = Lanes();
+    auto sequences = Lanes();
+    for (auto l = std::size_t{0}; l < nb_buyers; ++l) {
+      secrets[l] = secret_numbers[first + l];
+      prices[l] = secrets[l] % 10;
+    }
+    for (auto i = 0u; i < nb_secret_numbers; ++i) {
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+        secrets[l] = getNextSecretNumber(secrets[l]);
+      for (auto l = std::size_t{0}; l < nb_buyers; ++l) {
+        const auto price = secrets[l] % 10;
+        sequences[l] =
+            (sequences[l] * nb_changes + price + 9 - prices[l]) % nb_sequences;
+        prices[l] = price;
+        if (i + 1 < sequence_size)
+          continue;
+        auto &seen = market.seen[sequences[l]];
+        if ((seen & ~lane_mask) != stamp)
+          seen = stamp;
+        if ((seen & (1u << l)) == 0) {
+          seen |= 1u << l;
+          market.nb_bananas[sequences[l]] += price;
+        }
+      }
+    }
+    for (auto l = std::size_t{0}; l < nb_buyers; ++l)
+      market.secret_numbers_sum += secrets[l];
+  }
+
   Int m_secret_numbers_sum{0};
-  int m_max_nb_bananas{0};
+  uint m_max_nb_bananas{0};
 };
 
 } // namespace puzzle_2024_22
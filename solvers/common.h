@@ -6,9 +6,12 @@
 #include <QPen>
 #include <QStringList>
 #include <QVector>
+#include <algorithm>
 #include <functional>
 #include <iso646.h>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 namespace common {
 
@@ -45,48 +48,254 @@ unsigned long long toULongLong(const QString &input);
 QVector<unsigned long long> toVecULongLong(const QString &input,
                                            const QChar &split_char = ',');
 
-template <typename Data, typename Scalar, bool reversed = false> class OpenSet {
+// Indexed d-ary heap: push only lowers (or raises when reversed) the cost of
+// an element already in the set, and both push and pop are O(log n)
+template <typename Data, typename Scalar, bool reversed = false,
+          std::size_t arity = 4>
+class HeapOpenSet {
+  static_assert(arity >= 2, "common::HeapOpenSet: arity must be at least 2");
+
 public:
-  OpenSet() = default;
+  HeapOpenSet() = default;
+
+  bool empty() const { return m_heap.empty(); }
 
-  bool empty() const { return m_data.isEmpty(); }
+  int size() const { return static_cast<int>(m_heap.size()); }
 
-  int size() const { return m_data.size(); }
+  void reserve(int size) {
+    m_heap.reserve(static_cast<std::size_t>(size));
+    m_positions.reserve(size);
+  }
 
   std::optional<std::pair<Data, Scalar>> pop() {
-    if (m_data.isEmpty())
+    if (m_heap.empty())
       return std::nullopt;
-    auto it = std::min_element(std::cbegin(m_data), std::cend(m_data),
-                               [this](const Scalar &lhs, const Scalar &rhs) {
-                                 if constexpr (reversed)
-                                   return lhs > rhs;
-                                 else
-                                   return lhs < rhs;
-                               });
-    if (it == std::end(m_data))
+    auto res = std::move(m_heap.front());
+    m_positions.remove(res.first);
+    if (m_heap.size() > 1) {
+      place(0, std::move(m_heap.back()));
+      m_heap.pop_back();
+      siftDown(0);
+    } else {
+      m_heap.pop_back();
+    }
+    return res;
+  }
+
+  void push(const Data &data, Scalar cost) {
+    const auto it = m_positions.constFind(data);
+    if (it == m_positions.cend()) {
+      const auto position = m_heap.size();
+      m_positions.insert(data, position);
+      m_heap.emplace_back(data, cost);
+      siftUp(position);
+    } else if (before(cost, m_heap[it.value()].second)) {
+      const auto position = it.value();
+      m_heap[position].second = cost;
+      siftUp(position);
+    }
+  }
+
+private:
+  static bool before(const Scalar &lhs, const Scalar &rhs) {
+    if constexpr (reversed)
+      return lhs > rhs;
+    else
+      return lhs < rhs;
+  }
+
+  void place(std::size_t position, std::pair<Data, Scalar> &&item) {
+    m_heap[position] = std::move(item);
+    m_positions[m_heap[position].first] = position;
+  }
+
+  void siftUp(std::size_t position) {
+    auto item = std::move(m_heap[position]);
+    while (position > 0) {
+      const auto parent = (position - 1) / arity;
+      if (not before(item.second, m_heap[parent].second))
+        break;
+      place(position, std::move(m_heap[parent]));
+      position = parent;
+    }
+    place(position, std::move(item));
+  }
+
+  void siftDown(std::size_t position) {
+    auto item = std::move(m_heap[position]);
+    while (true) {
+      const auto first_child = arity * position + 1;
+      if (first_child >= m_heap.size())
+        break;
+      const auto last_child = std::min(first_child + arity, m_heap.size());
+      auto best = first_child;
+      for (auto child = first_child + 1; child < last_child; ++child)
+        if (before(m_heap[child].second, m_heap[best].second))
+          best = child;
+      if (not before(m_heap[best].second, item.second))
+        break;
+      place(position, std::move(m_heap[best]));
+      position = best;
+    }
+    place(position, std::move(item));
+  }
+
+  std::vector<std::pair<Data, Scalar>> m_heap{};
+  QHash<Data, std::size_t> m_positions{};
+};
+
+// Bucket queue for small integer costs, in the spirit of Dial's algorithm:
+// a growable ring of buckets indexed by the distance to the current cost.
+// Elements are neither deduplicated nor updated, callers which lower a cost
+// push again and skip the stale entry when it is popped.
+template <typename Data, typename Scalar, bool reversed = false>
+class BucketQueue {
+  static_assert(std::is_integral_v<Scalar>,
+                "common::BucketQueue expects integer costs");
+
+public:
+  BucketQueue() = default;
+
+  bool empty() const { return m_size == 0; }
+
+  std::size_t size() const { return m_size; }
+
+  void clear() {
+    for (auto &bucket : m_buckets)
+      bucket.clear();
+    m_size = 0;
+  }
+
+  std::optional<std::pair<Data, Scalar>> pop() {
+    if (m_size == 0)
       return std::nullopt;
-    auto res = std::make_pair(it.key(), it.value());
-    m_data.erase(it);
+    while (m_buckets[m_head].empty()) {
+      m_head = (m_head + 1) & m_mask;
+      if constexpr (reversed)
+        --m_current;
+      else
+        ++m_current;
+    }
+    auto &bucket = m_buckets[m_head];
+    auto res = std::make_pair(std::move(bucket.back()), m_current);
+    bucket.pop_back();
+    --m_size;
     return res;
   }
 
   void push(const Data &data, Scalar cost) {
-    if (m_data.contains(data)) {
-      auto &old_cost = m_data[data];
-      if constexpr (reversed) {
-        if (cost > old_cost)
-          old_cost = cost;
-      } else {
-        if (cost < old_cost)
-          old_cost = cost;
+    if (m_size == 0) {
+      m_current = cost;
+    } else if (before(cost, m_current)) {
+      const auto nb_missing = distance(cost, m_current);
+      reserve(span() + nb_missing);
+      m_head = (m_head - nb_missing) & m_mask;
+      m_current = cost;
+    }
+    const auto index = distance(m_current, cost);
+    if (index >= m_buckets.size())
+      reserve(index + 1);
+    m_buckets[(m_head + index) & m_mask].push_back(data);
+    ++m_size;
+  }
+
+private:
+  static bool before(Scalar lhs, Scalar rhs) {
+    if constexpr (reversed)
+      return lhs > rhs;
+    else
+      return lhs < rhs;
+  }
+
+  static std::size_t distance(Scalar from, Scalar to) {
+    if constexpr (reversed)
+      return static_cast<std::size_t>(from - to);
+    else
+      return static_cast<std::size_t>(to - from);
+  }
+
+  // Number of buckets from the head to the last non-empty one
+  std::size_t span() const {
+    auto res = m_buckets.size();
+    while (res > 0 and m_buckets[(m_head + res - 1) & m_mask].empty())
+      --res;
+    return res;
+  }
+
+  // Grows the ring to a power of two holding nb_buckets, keeping the buckets
+  // in order from the head
+  void reserve(std::size_t nb_buckets) {
+    if (nb_buckets <= m_buckets.size())
+      return;
+    auto capacity = std::max<std::size_t>(m_buckets.size(), 16);
+    while (capacity < nb_buckets)
+      capacity *= 2;
+    auto buckets = std::vector<std::vector<Data>>(capacity);
+    for (auto i = std::size_t{0}; i < m_buckets.size(); ++i)
+      buckets[i] = std::move(m_buckets[(m_head + i) & m_mask]);
+    m_buckets = std::move(buckets);
+    m_mask = capacity - 1;
+    m_head = 0;
+  }
+
+  std::vector<std::vector<Data>> m_buckets{};
+  std::size_t m_mask{0};
+  std::size_t m_head{0};
+  std::size_t m_size{0};
+  Scalar m_current{0};
+};
+
+// Open set on top of BucketQueue. Both operations are amortized O(1) when
+// popped costs are monotone, as in Dijkstra or A* with a consistent heuristic.
+// An improved cost leaves a stale entry behind, which is skipped when its
+// bucket is reached.
+template <typename Data, typename Scalar, bool reversed = false>
+class BucketOpenSet {
+public:
+  BucketOpenSet() = default;
+
+  bool empty() const { return m_costs.isEmpty(); }
+
+  int size() const { return m_costs.size(); }
+
+  std::optional<std::pair<Data, Scalar>> pop() {
+    while (auto item = m_queue.pop()) {
+      const auto it = m_costs.find(item->first);
+      if (it != m_costs.end() and it.value() == item->second) {
+        m_costs.erase(it);
+        return item;
       }
+    }
+    return std::nullopt;
+  }
+
+  void push(const Data &data, Scalar cost) {
+    if (m_costs.isEmpty())
+      m_queue.clear();
+    const auto it = m_costs.find(data);
+    if (it != m_costs.end()) {
+      if (not before(cost, it.value()))
+        return;
+      it.value() = cost;
     } else {
-      m_data[data] = cost;
+      m_costs.insert(data, cost);
     }
+    m_queue.push(data, cost);
   }
 
 private:
-  QHash<Data, Scalar> m_data;
+  static bool before(Scalar lhs, Scalar rhs) {
+    if constexpr (reversed)
+      return lhs > rhs;
+    else
+      return lhs < rhs;
+  }
+
+  BucketQueue<Data, Scalar, reversed> m_queue{};
+  QHash<Data, Scalar> m_costs{};
 };
 
+template <typename Data, typename Scalar, bool reversed = false>
+using OpenSet = HeapOpenSet<Data, Scalar, reversed>;
+
 } // namespace common
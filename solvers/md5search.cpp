@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstring>
+#include <solvers/md5search.h>
+#include <stdexcept>
+
+namespace common {
+
+namespace {
+
+constexpr auto nb_lanes = std::size_t{8};
+constexpr auto max_prefix_size = std::size_t{35};
+constexpr auto range_size = std::uint64_t{1} << 15;
+
+using Lanes = std::array<std::uint32_t, nb_lanes>;
+
+constexpr std::uint32_t sines[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+    0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+    0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+    0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+    0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+    0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+constexpr int shifts[64] = {7,  12, 17, 22, 7,  12, 17, 22, 7,  12, 17, 22, 7,
+                            12, 17, 22, 5,  9,  14, 20, 5,  9,  14, 20, 5,  9,
+                            14, 20, 5,  9,  14, 20, 4,  11, 16, 23, 4,  11, 16,
+                            23, 4,  11, 16, 23, 4,  11, 16, 23, 6,  10, 15, 21,
+                            6,  10, 15, 21, 6,  10, 15, 21, 6,  10, 15, 21};
+
+constexpr int message_indices[64] = {
+    0, 1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+    1, 6,  11, 0,  5,  10, 15, 4,  9,  14, 3,  8,  13, 2,  7,  12,
+    5, 8,  11, 14, 1,  4,  7,  10, 13, 0,  3,  6,  9,  12, 15, 2,
+    0, 7,  14, 5,  12, 3,  10, 1,  8,  15, 6,  13, 4,  11, 2,  9};
+
+// Single-block MD5 of nb_lanes messages at once. Every step is a loop over
+// the lanes so that the compiler maps it onto vector registers.
+void md5Lanes(const Lanes (&message)[16], Lanes (&digest)[4]) {
+  auto a = Lanes();
+  auto b = Lanes();
+  auto c = Lanes();
+  auto d = Lanes();
+  a.fill(0x67452301);
+  b.fill(0xefcdab89);
+  c.fill(0x98badcfe);
+  d.fill(0x10325476);
+  for (auto i = 0; i < 64; ++i) {
+    const auto &m = message[message_indices[i]];
+    const auto k = sines[i];
+    const auto s = shifts[i];
+    auto f = Lanes();
+    if (i < 16) {
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+        f[l] = d[l] ^ (b[l] & (c[l] ^ d[l]));
+    } else if (i < 32) {
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+        f[l] = c[l] ^ (d[l] & (b[l] ^ c[l]));
+    } else if (i < 48) {
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+        f[l] = b[l] ^ c[l] ^ d[l];
+    } else {
+      for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+        f[l] = c[l] ^ (b[l] | ~d[l]);
+    }
+    for (auto l = std::size_t{0}; l < nb_lanes; ++l) {
+      const auto x = a[l] + f[l] + k + m[l];
+      f[l] = b[l] + ((x << s) | (x >> (32 - s)));
+    }
+    a = d;
+    d = c;
+    c = b;
+    b = f;
+  }
+  for (auto l = std::size_t{0}; l < nb_lanes; ++l) {
+    digest[0][l] = a[l] + 0x67452301;
+    digest[1][l] = b[l] + 0xefcdab89;
+    digest[2][l] = c[l] + 0x98badcfe;
+    digest[3][l] = d[l] + 0x10325476;
+  }
+}
+
+std::size_t writeDecimal(std::uint64_t value, char *out) {
+  char digits[20];
+  auto nb_digits = std::size_t{0};
+  do {
+    digits[nb_digits++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  for (auto i = std::size_t{0}; i < nb_digits; ++i)
+    out[i] = digits[nb_digits - 1 - i];
+  return nb_digits;
+}
+
+std::uint32_t loadLittleEndian(const unsigned char *bytes) {
+  return static_cast<std::uint32_t>(bytes[0]) |
+         static_cast<std::uint32_t>(bytes[1]) << 8 |
+         static_cast<std::uint32_t>(bytes[2]) << 16 |
+         static_cast<std::uint32_t>(bytes[3]) << 24;
+}
+
+} // namespace
+
+char Md5Hit::hexDigit(std::size_t index) const {
+  const auto byte = digest[index / 2];
+  return "0123456789abcdef"[index % 2 == 0 ? byte >> 4 : byte & 0xf];
+}
+
+/******************************************************************************/
+
+Md5Search::Md5Search(const std::string &prefix, unsigned int nb_zeros,
+                     std::size_t nb_threads)
+    : m_prefix{prefix}, m_nb_threads{std::max(std::size_t{1}, nb_threads)} {
+  if (m_prefix.size() > max_prefix_size) {
+    throw std::invalid_argument("common::Md5Search: prefix \"" + prefix +
+                                "\" is too long");
+  }
+  if (nb_zeros > 32) {
+    throw std::invalid_argument(
+        "common::Md5Search: a digest has only 32 hexadecimal digits");
+  }
+  // Digest words are little-endian: the first hexadecimal digit is the high
+  // nibble of the lowest byte
+  for (auto i = 0u; i < nb_zeros; ++i) {
+    const auto byte = i / 2;
+    const auto nibble = i % 2 == 0 ? 0xf0u : 0x0fu;
+    m_masks[byte / 4] |= nibble << (8 * (byte % 4));
+  }
+}
+
+void Md5Search::searchRange(std::uint64_t begin, std::uint64_t end,
+                            std::vector<Md5Hit> &hits) const {
+  unsigned char bytes[nb_lanes][64];
+  Lanes message[16];
+  Lanes digest[4];
+  for (auto first = begin; first < end; first += nb_lanes) {
+    for (auto l = std::size_t{0}; l < nb_lanes; ++l) {
+      auto *block = bytes[l];
+      std::memset(block, 0, 64);
+      std::memcpy(block, m_prefix.data(), m_prefix.size());
+      auto size = m_prefix.size();
+      size += writeDecimal(first + l, reinterpret_cast<char *>(block) + size);
+      block[size] = 0x80;
+      const auto nb_bits = static_cast<std::uint64_t>(size) * 8;
+      for (auto i = 0; i < 8; ++i)
+        block[56 + i] = static_cast<unsigned char>(nb_bits >> (8 * i));
+      for (auto w = 0; w < 16; ++w)
+        message[w][l] = loadLittleEndian(block + 4 * w);
+    }
+    md5Lanes(message, digest);
+    auto candidates = 0u;
+    for (auto l = std::size_t{0}; l < nb_lanes; ++l)
+      candidates |= ((digest[0][l] & m_masks[0]) == 0 ? 1u : 0u) << l;
+    for (auto l = std::size_t{0}; candidates != 0; ++l, candidates >>= 1) {
+      if ((candidates & 1u) == 0 or first + l >= end)
+        continue;
+      auto match = true;
+      for (auto w = 1; w < 4; ++w)
+        match = match and (digest[w][l] & m_masks[w]) == 0;
+      if (not match)
+        continue;
+      auto hit = Md5Hit();
+      hit.nonce = first + l;
+      for (auto w = 0; w < 4; ++w)
+        for (auto i = 0; i < 4; ++i)
+          hit.digest[4 * w + i] =
+              static_cast<std::uint8_t>(digest[w][l] >> (8 * i));
+      hits.push_back(hit);
+    }
+  }
+}
+
+bool Md5Search::run(std::uint64_t first,
+                    const std::function<bool(const Md5Hit &)> &on_hit,
+                    const std::function<bool()> &cancelled) const {
+  auto hits = std::vector<std::vector<Md5Hit>>(m_nb_threads);
+  while (true) {
+    if (cancelled and cancelled())
+      return false;
+    // One round covers m_nb_threads consecutive ranges, so reporting the hits
+    // range by range keeps them in increasing nonce order
+    parallelFor(
+        0, m_nb_threads,
+        [&](std::size_t i) {
+          hits[i].clear();
+          const auto begin = first + i * range_size;
+          searchRange(begin, begin + range_size, hits[i]);
+        },
+        m_nb_threads);
+    for (const auto &range_hits : hits)
+      for (const auto &hit : range_hits)
+        if (not on_hit(hit))
+          return true;
+    first += m_nb_threads * range_size;
+  }
+}
+
+std::optional<Md5Hit>
+Md5Search::smallest(std::uint64_t first,
+                    const std::function<bool()> &cancelled) const {
+  auto res = std::optional<Md5Hit>();
+  run(
+      first,
+      [&res](const Md5Hit &hit) {
+        res = hit;
+        return false;
+      },
+      cancelled);
+  return res;
+}
+
+} // namespace common
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <solvers/threadpool.h>
+#include <string>
+#include <vector>
+
+namespace common {
+
+struct Md5Hit {
+  std::uint64_t nonce{0};
+  std::array<std::uint8_t, 16> digest{};
+
+  // Character of the hexadecimal representation of the digest
+  char hexDigit(std::size_t index) const;
+};
+
+// Searches the nonces n for which the MD5 digest of prefix + decimal(n) starts
+// with nb_zeros hexadecimal zeros. Nonces are hashed several at a time by a
+// multi-lane kernel, and consecutive ranges are split across threads.
+class Md5Search {
+public:
+  Md5Search(const std::string &prefix, unsigned int nb_zeros,
+            std::size_t nb_threads = nbHardwareThreads());
+
+  // Calls on_hit on every hit from nonce first on, in increasing nonce order,
+  // until on_hit returns false. Returns false if the search was cancelled.
+  bool run(std::uint64_t first,
+           const std::function<bool(const Md5Hit &)> &on_hit,
+           const std::function<bool()> &cancelled = {}) const;
+
+  std::optional<Md5Hit>
+  smallest(std::uint64_t first = 0,
+           const std::function<bool()> &cancelled = {}) const;
+
+private:
+  void searchRange(std::uint64_t begin, std::uint64_t end,
+                   std::vector<Md5Hit> &hits) const;
+
+  std::string m_prefix;
+  std::array<std::uint32_t, 4> m_masks{};
+  std::size_t m_nb_threads;
+};
+
+} // namespace common
@@ -1,3 +1,4 @@
+#include <QThread>
 #include <solvers/solvers.h>
 
 #include <solvers/2015/event_2015.h>
@@ -12,7 +13,63 @@
 #include <solvers/2024/event_2024.h>
 #include <solvers/2025/event_2025.h>
 
+Solver::~Solver() {
+  cancel();
+  wait();
+  delete m_thread;
+}
+
+void Solver::start(const QString &input) {
+  if (m_thread) {
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+  }
+  m_cancellation_requested = false;
+  m_progress_timer.invalidate();
+  if (requiresGuiThread()) {
+    run(input);
+    return;
+  }
+  m_thread = QThread::create([this, input]() { run(input); });
+  m_thread->start();
+}
+
+void Solver::cancel() { m_cancellation_requested = true; }
+
+bool Solver::isRunning() const { return m_thread and m_thread->isRunning(); }
+
+void Solver::wait() {
+  if (m_thread)
+    m_thread->wait();
+}
+
+bool Solver::cancellationRequested() const {
+  return m_cancellation_requested.load(std::memory_order_relaxed);
+}
+
+void Solver::reportProgress(qint64 current, qint64 total) {
+  if (m_progress_timer.isValid() and m_progress_timer.elapsed() < 100 and
+      current < total)
+    return;
+  m_progress_timer.start();
+  emit progress(current, total);
+}
+
+void Solver::run(const QString &input) {
+  try {
+    solve(input);
+  } catch (const std::exception &e) {
+    emit finished(QString("ERROR: %1").arg(e.what()));
+  }
+  if (cancellationRequested())
+    emit cancelled();
+}
+
+/******************************************************************************/
+
 Solvers::Solvers() {
+  qRegisterMetaType<DisplayData>("DisplayData");
   m_solvers[2015][1][1] = new Solver_2015_01_1();
   m_solvers[2015][1][2] = new Solver_2015_01_2();
   m_solvers[2015][2][1] = new Solver_2015_02_1();
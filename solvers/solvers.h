@@ -1,13 +1,17 @@
 #pragma once
 
 #include <QBrush>
+#include <QElapsedTimer>
 #include <QMap>
 #include <QObject>
 #include <QPen>
 #include <QRect>
 #include <QString>
+#include <atomic>
 #include <vector>
 
+class QThread;
+
 template <typename ObjectType> struct DisplayObject {
 
   DisplayObject() = default;
@@ -55,10 +59,31 @@ signals:
   void finished(const QString &output);
   void output(const QString &data);
   void display(const DisplayData &data);
+  void progress(qint64 current, qint64 total);
+  void cancelled();
 
 public:
-  virtual ~Solver() {}
+  virtual ~Solver();
   virtual void solve(const QString &input) = 0;
+
+  // Solvers creating widgets must stay on the GUI thread
+  virtual bool requiresGuiThread() const { return false; }
+
+  void start(const QString &input);
+  void cancel();
+  bool isRunning() const;
+  void wait();
+  bool cancellationRequested() const;
+
+protected:
+  void reportProgress(qint64 current, qint64 total);
+
+private:
+  void run(const QString &input);
+
+  QThread *m_thread{nullptr};
+  std::atomic_bool m_cancellation_requested{false};
+  QElapsedTimer m_progress_timer;
 };
 
 struct Solvers {
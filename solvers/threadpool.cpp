@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <solvers/threadpool.h>
+
+namespace common {
+
+namespace {
+
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+} // namespace
+
+std::size_t nbHardwareThreads() {
+  const auto nb_threads = std::thread::hardware_concurrency();
+  return nb_threads == 0u ? std::size_t{1} : std::size_t{nb_threads};
+}
+
+ThreadPool::ThreadPool(std::size_t nb_workers) {
+  if (nb_workers == 0)
+    nb_workers = 1;
+  m_queues.reserve(nb_workers);
+  for (auto i = std::size_t{0}; i < nb_workers; ++i)
+    m_queues.emplace_back(std::make_unique<Queue>());
+  m_workers.reserve(nb_workers);
+  for (auto i = std::size_t{0}; i < nb_workers; ++i)
+    m_workers.emplace_back([this, i]() { work(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const auto lock = std::lock_guard<std::mutex>(m_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+  const auto index = current_pool == this
+                         ? current_worker
+                         : m_next_queue++ % m_queues.size();
+  ++m_pending;
+  {
+    // Counted under the queue lock, so that pop and steal, which decrement
+    // under the same lock, never see the task before its count
+    auto &queue = *m_queues[index];
+    const auto lock = std::lock_guard<std::mutex>(queue.mutex);
+    queue.tasks.emplace_back(std::move(task));
+    ++m_queued;
+  }
+  {
+    // Orders the count with the wake predicate of the workers, otherwise a
+    // worker about to wait could miss the notification
+    const auto lock = std::lock_guard<std::mutex>(m_mutex);
+  }
+  m_wake.notify_one();
+}
+
+void ThreadPool::wait() {
+  auto lock = std::unique_lock<std::mutex>(m_mutex);
+  m_idle.wait(lock, [this]() { return m_pending == 0; });
+  if (m_error) {
+    auto error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+bool ThreadPool::pop(std::size_t index, Task &task) {
+  auto &queue = *m_queues[index];
+  const auto lock = std::lock_guard<std::mutex>(queue.mutex);
+  if (queue.tasks.empty())
+    return false;
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  --m_queued;
+  return true;
+}
+
+bool ThreadPool::steal(std::size_t index, Task &task) {
+  const auto nb_queues = m_queues.size();
+  for (auto offset = std::size_t{1}; offset < nb_queues; ++offset) {
+    auto &queue = *m_queues[(index + offset) % nb_queues];
+    const auto lock = std::lock_guard<std::mutex>(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    --m_queued;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::work(std::size_t index) {
+  current_pool = this;
+  current_worker = index;
+  while (true) {
+    auto task = Task{};
+    if (pop(index, task) or steal(index, task)) {
+      try {
+        task();
+      } catch (...) {
+        const auto lock = std::lock_guard<std::mutex>(m_mutex);
+        if (not m_error)
+          m_error = std::current_exception();
+      }
+      if (--m_pending == 0) {
+        const auto lock = std::lock_guard<std::mutex>(m_mutex);
+        m_idle.notify_all();
+      }
+      continue;
+    }
+    auto lock = std::unique_lock<std::mutex>(m_mutex);
+    m_wake.wait(lock, [this]() { return m_stopping or m_queued > 0; });
+    if (m_stopping and m_queued == 0)
+      return;
+  }
+}
+
+void parallelFor(std::size_t begin, std::size_t end,
+                 const std::function<void(std::size_t)> &function,
+                 std::size_t nb_threads) {
+  if (begin >= end)
+    return;
+  nb_threads = std::max(std::size_t{1}, std::min(nb_threads, end - begin));
+  if (nb_threads == 1) {
+    for (auto i = begin; i < end; ++i)
+      function(i);
+    return;
+  }
+  auto next = std::atomic<std::size_t>{begin};
+  auto error = std::exception_ptr{};
+  auto error_mutex = std::mutex{};
+  const auto work = [&]() {
+    try {
+      for (auto i = next++; i < end; i = next++)
+        function(i);
+    } catch (...) {
+      const auto lock = std::lock_guard<std::mutex>(error_mutex);
+      if (not error)
+        error = std::current_exception();
+      next = end;
+    }
+  };
+  auto threads = std::vector<std::thread>();
+  threads.reserve(nb_threads - 1);
+  for (auto i = std::size_t{1}; i < nb_threads; ++i)
+    threads.emplace_back(work);
+  work();
+  for (auto &thread : threads)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace common
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common {
+
+std::size_t nbHardwareThreads();
+
+// Work-stealing pool: each worker pops from the back of its own queue and
+// steals from the front of the others when it runs dry.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(std::size_t nb_workers = nbHardwareThreads());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  std::size_t size() const { return m_workers.size(); }
+
+  void submit(Task task);
+
+  // Blocks until every submitted task is done, then rethrows the first
+  // exception raised by a task. Must not be called from a task.
+  void wait();
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool pop(std::size_t index, Task &task);
+  bool steal(std::size_t index, Task &task);
+  void work(std::size_t index);
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_idle;
+  std::atomic<std::size_t> m_queued{0};
+  std::atomic<std::size_t> m_pending{0};
+  std::atomic<std::size_t> m_next_queue{0};
+  std::exception_ptr m_error;
+  bool m_stopping{false};
+};
+
+// Calls function(i) for every i in [begin, end) on short-lived threads. Safe
+// to use from inside a ThreadPool task.
+void parallelFor(std::size_t begin, std::size_t end,
+                 const std::function<void(std::size_t)> &function,
+                 std::size_t nb_threads = nbHardwareThreads());
+
+} // namespace common